@@ -0,0 +1,222 @@
+// Offline counterpart of the mod: provisions world directories without booting a server, several worlds at a time.
+
+#include "LegacyAddonsCore/AddonWorld.h"
+#include "LegacyAddonsCore/DropFolderInstaller.h"
+#include "LegacyAddonsCore/StringUtils.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+using namespace legacy_addons_manager;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view USAGE = R"(Usage: LegacyAddonsCli [options] <command> [arguments]
+
+Commands:
+  install <archive>...              Install .mcpack/.mcaddon/.zip archives, the archives are kept
+  scan                              List the installed addons
+  enable [--with-deps] <addon>...   Enable addons by name or uuid, with their dependencies if asked
+  disable <addon>...                Disable addons by name or uuid
+  verify                            Check the installed addons and pack lists, changing nothing
+  watch <folder>                    Install archives dropped into folder until interrupted, one world only
+
+Options:
+  --world <dir>                     World directory to work on, repeat for several worlds
+  --jobs <n>                        Worlds processed at the same time, the number of CPU threads by default
+  --lang <file>                     Translation file, lang/en.json next to the executable by default
+)";
+
+struct Arguments {
+    std::string              command;
+    std::vector<std::string> targets;
+    std::vector<fs::path>    worlds;
+    size_t                   jobs = std::max(1u, std::thread::hardware_concurrency());
+    fs::path                 langFile;
+    bool                     withDependencies = false;
+};
+
+std::optional<Arguments> ParseArguments(int argc, char** argv) {
+    Arguments args;
+    args.langFile = fs::absolute(argv[0]).parent_path() / "lang" / "en.json";
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto             value = [&]() -> std::optional<std::string> {
+            if (i + 1 >= argc) return std::nullopt;
+            return argv[++i];
+        };
+        if (arg == "--world" || arg == "--jobs" || arg == "--lang") {
+            auto v = value();
+            if (!v) return std::nullopt;
+            if (arg == "--world") {
+                // Without the trailing separator, so the world is named after its directory
+                auto world = fs::absolute(FromUtf8(*v)).lexically_normal();
+                args.worlds.push_back(world.has_filename() ? world : world.parent_path());
+            } else if (arg == "--lang") args.langFile = FromUtf8(*v);
+            else args.jobs = std::max<size_t>(1, std::strtoul(v->c_str(), nullptr, 10));
+        } else if (arg == "--with-deps") {
+            args.withDependencies = true;
+        } else if (arg.starts_with("--")) {
+            return std::nullopt;
+        } else if (args.command.empty()) {
+            args.command = arg;
+        } else {
+            args.targets.emplace_back(arg);
+        }
+    }
+    static const std::set<std::string> COMMANDS = {"install", "scan", "enable", "disable", "verify", "watch"};
+    if (!COMMANDS.contains(args.command) || args.worlds.empty()) return std::nullopt;
+    bool needsTargets = args.command == "install" || args.command == "enable" || args.command == "disable";
+    if (args.command == "watch") {
+        if (args.targets.size() != 1 || args.worlds.size() != 1) return std::nullopt;
+    } else if (needsTargets == args.targets.empty()) {
+        return std::nullopt;
+    }
+    return args;
+}
+
+// The lang files are nested objects, keys are the dotted paths to their strings
+void FlattenLang(nlohmann::json const& node, std::string const& prefix, std::unordered_map<std::string, std::string>& res) {
+    for (auto& [key, value] : node.items()) {
+        if (value.is_object()) FlattenLang(value, prefix + key + ".", res);
+        else if (value.is_string()) res[prefix + key] = value.get<std::string>();
+    }
+}
+
+std::unordered_map<std::string, std::string> LoadLang(fs::path const& file) {
+    std::unordered_map<std::string, std::string> res;
+    std::ifstream                                fin(file, std::ios::binary);
+    if (!fin) return res;
+    auto lang = nlohmann::json::parse(fin, nullptr, false, true);
+    if (lang.is_object()) FlattenLang(lang, "", res);
+    return res;
+}
+
+std::mutex outputMutex;
+
+volatile std::sig_atomic_t interrupted = 0;
+
+Logger MakeLogger(std::string worldName, std::unordered_map<std::string, std::string> const& lang) {
+    return Logger(
+        [worldName = std::move(worldName)](Logger::Level level, std::string const& message) {
+            constexpr std::string_view LEVEL_NAMES[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+            if (level == Logger::Level::Debug) return;
+            std::lock_guard lock(outputMutex);
+            std::cerr << "[" << worldName << "] " << LEVEL_NAMES[static_cast<int>(level)] << " "
+                      << RemoveEscapeCode(message) << "\n";
+        },
+        [&lang](std::string const& key) {
+            auto it = lang.find(key);
+            return it == lang.end() ? key : it->second;
+        }
+    );
+}
+
+std::string Scan(AddonWorld& world) {
+    std::ostringstream oss;
+    oss << ToUtf8(world.directory()) << ": " << world.addons().size() << " addon(s)\n";
+    for (auto& addon : world.addons()) {
+        oss << (addon.enable ? "  [x] " : "  [ ] ") << RemoveEscapeCode(addon.name) << " v" << addon.version.to_string()
+            << " (" << addon.uuid << ", "
+            << (addon.type == Addon::Type::ResourcePack ? "ResourcePack" : "BehaviorPack") << ")\n";
+    }
+    return oss.str();
+}
+
+bool Run(Arguments const& args, size_t index, fs::path const& tempRoot, Logger logger) {
+    AddonWorld world(
+        AddonWorld::Options{
+            .worldDir            = args.worlds[index],
+            .tempDir             = tempRoot / std::to_string(index),
+            .validationCacheFile = {},
+            .snapshotKeep        = 3,
+            .maxNesting          = 4,
+            .extractLimits       = {},
+        },
+        std::move(logger)
+    );
+    world.load();
+
+    bool ok = true;
+    if (args.command == "install") {
+        for (auto& target : args.targets) ok = ok && world.install(FromUtf8(target), false);
+    } else if (args.command == "enable") {
+        for (auto& target : args.targets) ok = world.enable(target, args.withDependencies) && ok;
+    } else if (args.command == "disable") {
+        for (auto& target : args.targets) ok = world.disable(target) && ok;
+    } else if (args.command == "verify") {
+        ok = world.verify() == 0;
+    } else if (args.command == "watch") {
+        auto                 folder = FromUtf8(args.targets.front());
+        std::recursive_mutex worldMutex;
+        DropFolderInstaller  installer(folder, world, worldMutex);
+        world.installDirectory(folder);
+        installer.start();
+        while (!interrupted) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        installer.stop();
+    } else if (args.command == "scan") {
+        auto listing = Scan(world);
+        std::lock_guard lock(outputMutex);
+        std::cout << listing;
+    }
+    if (args.command == "install") world.refreshClientPackCache();
+
+    std::error_code ec;
+    fs::remove_all(tempRoot / std::to_string(index), ec);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto args = ParseArguments(argc, argv);
+    if (!args) {
+        std::cerr << USAGE;
+        return 2;
+    }
+    auto lang = LoadLang(args->langFile);
+    std::signal(SIGINT, [](int) { interrupted = 1; });
+    std::signal(SIGTERM, [](int) { interrupted = 1; });
+
+    auto tempRoot = fs::temp_directory_path() / ("LegacyAddonsCli-" + std::to_string(std::random_device{}()));
+
+    // Worlds are independent of each other, so each one gets a worker to itself
+    std::atomic<size_t> next   = 0;
+    std::atomic<bool>   failed = false;
+    auto                worker = [&]() {
+        for (size_t i = next++; i < args->worlds.size(); i = next++) {
+            auto worldName = ToUtf8(args->worlds[i].filename());
+            try {
+                if (!Run(*args, i, tempRoot, MakeLogger(worldName, lang))) failed = true;
+            } catch (const std::exception& e) {
+                std::lock_guard lock(outputMutex);
+                std::cerr << "[" << worldName << "] ERROR " << e.what() << "\n";
+                failed = true;
+            }
+        }
+    };
+    size_t                   threadCount = std::min(args->jobs, args->worlds.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    std::error_code ec;
+    fs::remove_all(tempRoot, ec);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,72 @@
+#include "Addon.h"
+#include "LaxJson.h"
+#include "StringUtils.h"
+#include "nlohmann/json.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+std::string Version::to_string() const {
+    return std::to_string(major) + "." + std::to_string(minor) + "." + std::to_string(patch);
+}
+
+Version ParseVersion(nlohmann::json const& value) {
+    Version version;
+    if (value.is_array() && value.size() >= 3 && value[0].is_number_integer() && value[1].is_number_integer()
+        && value[2].is_number_integer()) {
+        version.major = value[0].get<int>();
+        version.minor = value[1].get<int>();
+        version.patch = value[2].get<int>();
+    } else if (value.is_string()) {
+        std::istringstream iss(value.get<std::string>());
+        char               dot1 = 0, dot2 = 0;
+        iss >> version.major >> dot1 >> version.minor >> dot2 >> version.patch;
+        if (!iss || dot1 != '.' || dot2 != '.') throw std::runtime_error("Invalid version in manifest!");
+    } else {
+        throw std::runtime_error("Invalid version in manifest!");
+    }
+    return version;
+}
+
+Addon ReadAddon(fs::path const& addonPath) {
+    auto manifestPath = addonPath / "manifest.json";
+    if (!fs::exists(manifestPath)) manifestPath = addonPath / "pack_manifest.json";
+
+    std::ifstream fin(manifestPath, std::ios::binary);
+    if (!fin) throw std::runtime_error("manifest.json not found!");
+    std::string content{std::istreambuf_iterator<char>(fin), {}};
+    if (content.empty()) throw std::runtime_error("manifest.json not found!");
+
+    try {
+        auto  manifest = nlohmann::json::parse(NormalizeLaxJson(content), nullptr, true, true);
+        auto& header   = manifest.at("header");
+        Addon addon;
+        addon.name        = header.at("name");
+        addon.description = header.value("description", "");
+        addon.uuid        = header.at("uuid");
+        addon.version     = ParseVersion(header.at("version"));
+        addon.directory   = ToUtf8(addonPath);
+
+        std::string type = manifest.at("modules").at(0).at("type");
+        if (type == "resources") addon.type = Addon::Type::ResourcePack;
+        else if (type == "data" || type == "script") addon.type = Addon::Type::BehaviorPack;
+        else throw std::runtime_error("Unknown type of addon pack!");
+        for (auto& module : manifest["modules"])
+            if (module.contains("uuid")) addon.moduleUuids.push_back(module["uuid"]);
+
+        if (manifest.contains("dependencies")) {
+            for (auto& dependency : manifest["dependencies"])
+                if (dependency.contains("uuid")) addon.dependencies.push_back(dependency["uuid"]);
+        }
+        return addon;
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error(std::string("Invalid manifest.json: ") + e.what());
+    }
+}
+
+} // namespace legacy_addons_manager
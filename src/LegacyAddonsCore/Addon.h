@@ -0,0 +1,46 @@
+#pragma once
+
+#include "nlohmann/json_fwd.hpp"
+
+#include <compare>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+struct Version {
+    int major = 0;
+    int minor = 0;
+    int patch = 0;
+
+    [[nodiscard]] std::string to_string() const;
+
+    auto operator<=>(Version const&) const = default;
+};
+
+struct Addon {
+    enum class Type { ResourcePack, BehaviorPack };
+    std::string name;
+    std::string description;
+    Type        type = Type::ResourcePack;
+    Version     version;
+    std::string uuid;
+    std::string directory; // UTF-8
+    bool        enable = false;
+
+    std::vector<std::string> moduleUuids;
+    std::vector<std::string> dependencies; // uuids of the packs this one depends on
+};
+
+inline bool IsManifestFile(std::string const& filename) {
+    return filename == "manifest.json" || filename == "pack_manifest.json";
+}
+
+// Either [1, 0, 0] or, in newer manifests, "1.0.0". Throws std::runtime_error if it is neither.
+Version ParseVersion(nlohmann::json const& value);
+
+// Read the manifest of the pack in addonPath. Throws std::runtime_error if it isn't a usable pack.
+Addon ReadAddon(std::filesystem::path const& addonPath);
+
+} // namespace legacy_addons_manager
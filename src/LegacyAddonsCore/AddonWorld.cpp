@@ -0,0 +1,851 @@
+#include "AddonWorld.h"
+#include "StringUtils.h"
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+const std::set<std::string> VALID_ADDON_FILE_EXTENSIONS = {".mcpack", ".mcaddon", ".zip"};
+
+// Packs extracted and checked, waiting on the world's volume to be renamed into place
+constexpr std::string_view PENDING_DIRECTORY = ".pending_installs";
+
+std::optional<std::string> ReadFile(fs::path const& path) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) return std::nullopt;
+    return std::string{std::istreambuf_iterator<char>(fin), {}};
+}
+
+bool WriteFile(fs::path const& path, std::string_view content) {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return static_cast<bool>(fout.flush());
+}
+
+// Stage every list before replacing any of them, and keep the replaced ones until all of them are in place, so a
+// failure leaves every list as it was. failedFile is set to the list that couldn't be written.
+bool WriteLists(std::vector<std::pair<fs::path, nlohmann::json>> const& lists, fs::path* failedFile = nullptr) {
+    auto withSuffix = [](fs::path path, std::string_view suffix) { return path += suffix; };
+    std::error_code ec;
+    auto            fail = [&](fs::path const& file) {
+        if (failedFile) *failedFile = file;
+        for (auto& [other, list] : lists) fs::remove(withSuffix(other, ".tmp"), ec);
+        return false;
+    };
+    for (auto& [file, list] : lists)
+        if (!WriteFile(withSuffix(file, ".tmp"), list.dump(4))) return fail(file);
+
+    std::vector<std::pair<fs::path, bool>> replaced; // list, whether it existed before
+    auto                                   restore = [&](fs::path const& file) {
+        for (auto& [done, existed] : replaced) {
+            if (existed) fs::rename(withSuffix(done, ".bak"), done, ec);
+            else fs::remove(done, ec);
+        }
+        return fail(file);
+    };
+    for (auto& [file, list] : lists) {
+        bool existed = fs::exists(file, ec);
+        if (existed && !fs::copy_file(file, withSuffix(file, ".bak"), fs::copy_options::overwrite_existing, ec))
+            return restore(file);
+        fs::rename(withSuffix(file, ".tmp"), file, ec);
+        if (ec) {
+            if (existed) fs::remove(withSuffix(file, ".bak"), ec);
+            return restore(file);
+        }
+        replaced.emplace_back(file, existed);
+    }
+    for (auto& [file, existed] : replaced)
+        if (existed) fs::remove(withSuffix(file, ".bak"), ec);
+    return true;
+}
+
+nlohmann::json MakeListEntry(Addon const& addon) {
+    auto entry       = nlohmann::json::object();
+    entry["pack_id"] = addon.uuid;
+    entry["version"] = {addon.version.major, addon.version.minor, addon.version.patch};
+    return entry;
+}
+
+bool IsListEntry(nlohmann::json const& item) {
+    return item.is_object() && item.contains("pack_id") && item["pack_id"].is_string();
+}
+
+} // namespace
+
+bool IsAddonArchive(fs::path const& path) { return VALID_ADDON_FILE_EXTENSIONS.contains(ToUtf8(path.extension())); }
+
+AddonWorld::AddonWorld(Options options, Logger logger)
+: mOptions(std::move(options)),
+  mLogger(std::move(logger)),
+  mClientPackCache(fs::absolute(mOptions.worldDir) / "client_pack_cache"),
+  mPackValidator(mOptions.validationCacheFile),
+  mInstallJournal(fs::absolute(mOptions.worldDir) / "install.journal"),
+  mPackSnapshots(fs::absolute(mOptions.worldDir) / "pack_snapshots", mOptions.snapshotKeep) {
+    // The journal records absolute paths, so recovery doesn't depend on the working directory
+    mOptions.worldDir = fs::absolute(mOptions.worldDir);
+    mOptions.tempDir  = fs::absolute(mOptions.tempDir);
+
+    // Replaced versions are kept for rollback, resource packs along with their client download archive
+    mInstallJournal.onRetire([this](InstallJournal::Transaction const& tx) {
+        auto previous = readAddon(tx.backup);
+        if (!previous) return;
+        auto version = previous->version.to_string();
+        mPackSnapshots.retain(tx.uuid, version, tx.backup);
+        if (previous->type == Addon::Type::ResourcePack) {
+            auto snapshot = mPackSnapshots.path(tx.uuid, version);
+            mClientPackCache.stash(tx.uuid, snapshot, mPackSnapshots.archivePath(tx.uuid, version));
+        }
+    });
+}
+
+fs::path AddonWorld::listFile(Addon::Type type) const {
+    switch (type) {
+    case Addon::Type::BehaviorPack:
+        return mOptions.worldDir / "world_behavior_packs.json";
+    case Addon::Type::ResourcePack:
+        return mOptions.worldDir / "world_resource_packs.json";
+    default:
+        break;
+    }
+    return {};
+}
+
+std::optional<Addon> AddonWorld::readAddon(fs::path const& addonPath) const {
+    try {
+        return ReadAddon(addonPath);
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.error.invalidAddon", addonPath);
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+    return std::nullopt;
+}
+
+void AddonWorld::rebuildDependencyGraph() {
+    std::vector<DependencyGraph::Pack> packs;
+    packs.reserve(mAddons.size());
+    for (auto& addon : mAddons) packs.push_back({addon.uuid, addon.dependencies});
+    mDependencyGraph = DependencyGraph(packs);
+
+    // Only new cycles are reported, the graph is rebuilt on every install, enable and disable
+    std::set<std::string> cycles;
+    for (auto& cycle : mDependencyGraph.findCycles()) {
+        // The same cycle is found from whichever pack comes first, start it at the same one every time
+        std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()), cycle.end());
+        std::string path;
+        for (auto& uuid : cycle) path += uuid + " -> ";
+        path += cycle.front();
+        if (!mReportedCycles.contains(path)) mLogger.warn("ll.addonsHelper.dependency.cycle", path);
+        cycles.insert(std::move(path));
+    }
+    mReportedCycles = std::move(cycles);
+}
+
+void AddonWorld::registerAddon(Addon addon) {
+    auto it = std::find_if(mAddons.begin(), mAddons.end(), [&](Addon const& a) { return a.uuid == addon.uuid; });
+    mSearchIndex.add(addon.uuid, addon.name, addon.description);
+    if (it != mAddons.end()) *it = std::move(addon);
+    else mAddons.emplace_back(std::move(addon));
+    rebuildDependencyGraph();
+}
+
+void AddonWorld::unregisterAddon(std::string const& uuid) {
+    auto it = std::find_if(mAddons.begin(), mAddons.end(), [&](Addon const& a) { return a.uuid == uuid; });
+    if (it == mAddons.end()) return;
+    mSearchIndex.remove(uuid);
+    mAddons.erase(it);
+    rebuildDependencyGraph();
+}
+
+// Read a world pack list, a broken one is backed up and reset
+nlohmann::json AddonWorld::readList(fs::path const& file) const {
+    if (!fs::exists(file)) return nlohmann::json::array();
+
+    auto list = nlohmann::json::parse(ReadFile(file).value_or(""), nullptr, false, true);
+    if (!list.is_array()) {
+        auto backup = file.stem();
+        backup     += "_error.json";
+        mLogger.error("ll.addonsHelper.addAddonToList.invalidList", file, backup);
+        std::error_code ec;
+        fs::rename(file, file.parent_path() / backup, ec);
+        list = nlohmann::json::array();
+    }
+    return list;
+}
+
+// Put packs before the packs they depend on, so they take priority over them
+nlohmann::json AddonWorld::sortList(nlohmann::json const& list) const {
+    std::vector<std::string>                                      uuids;
+    std::unordered_map<std::string, std::vector<nlohmann::json>> entries;
+    auto                                                          others = nlohmann::json::array();
+    for (auto& item : list) {
+        if (IsListEntry(item)) {
+            std::string uuid   = item["pack_id"];
+            auto&       bucket = entries[uuid];
+            if (bucket.empty()) uuids.push_back(uuid);
+            bucket.push_back(item);
+        } else {
+            others.push_back(item);
+        }
+    }
+    auto res = nlohmann::json::array();
+    for (auto& uuid : mDependencyGraph.order(uuids))
+        for (auto& item : entries[uuid]) res.push_back(std::move(item));
+    for (auto& item : others) res.push_back(std::move(item));
+    return res;
+}
+
+bool AddonWorld::removeFromList(Addon& addon) {
+    auto file    = listFile(addon.type);
+    auto content = ReadFile(file);
+    if (!content || content->empty()) {
+        mLogger.error("ll.addonsHelper.error.addonConfigNotFound");
+        return false;
+    }
+    auto list = nlohmann::json::parse(*content, nullptr, true, true);
+    for (size_t id = 0; id < list.size(); ++id) {
+        if (list[id]["pack_id"] != addon.uuid) continue;
+        list.erase(id);
+        if (!WriteLists({
+                {file, list}
+        })) {
+            mLogger.error("ll.addonsHelper.removeAddonFromList.fail", addon.name);
+            return false;
+        }
+        mLogger.info("ll.addonsHelper.removeAddonFromList.success", addon.name);
+        return true;
+    }
+    mLogger.error("ll.addonsHelper.error.addonNotFound", addon.name);
+    return false;
+}
+
+bool AddonWorld::addToList(Addon& addon) {
+    auto file = listFile(addon.type);
+    try {
+        bool exists = false;
+        auto list   = readList(file);
+        for (auto& item : list) {
+            if (item["pack_id"] == addon.uuid) {
+                item["version"] = {addon.version.major, addon.version.minor, addon.version.patch};
+                exists          = true;
+                break;
+            }
+        }
+        if (!exists) list.push_back(MakeListEntry(addon));
+        if (!WriteLists({
+                {file, sortList(list)}
+        }))
+            throw std::runtime_error("Fail to write data back to addon list file!");
+        mLogger.info("ll.addonsHelper.addAddonToList.success", addon.name);
+        return true;
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.addAddonToList.fail", addon.name, file);
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+        mLogger.error("ll.addonsHelper.error.installationAborted");
+        return false;
+    }
+}
+
+// Enable the pack and everything it depends on, both list files are committed together
+bool AddonWorld::addWithDependenciesToList(Addon& addon) {
+    auto index = mDependencyGraph.indexOf(addon.uuid);
+    if (!index) return false;
+    std::vector<std::string> missing;
+    auto                     closure = mDependencyGraph.closure(*index, &missing);
+    for (auto& uuid : missing) mLogger.warn("ll.addonsHelper.dependency.missing", addon.name, uuid);
+
+    auto resourcePackListFile = listFile(Addon::Type::ResourcePack);
+    auto behaviorPackListFile = listFile(Addon::Type::BehaviorPack);
+    auto failedFile           = resourcePackListFile;
+    try {
+        auto resourcePackList = readList(resourcePackListFile);
+        failedFile            = behaviorPackListFile;
+        auto behaviorPackList = readList(behaviorPackListFile);
+
+        // Entries already listed get the installed version, the others are appended
+        std::unordered_map<std::string, Addon const*> packs;
+        for (auto node : closure) packs.emplace(mAddons[node].uuid, &mAddons[node]);
+        std::unordered_set<std::string> listed;
+        for (auto* list : {&resourcePackList, &behaviorPackList}) {
+            for (auto& item : *list) {
+                if (!IsListEntry(item)) continue;
+                auto uuid = item["pack_id"].get<std::string>();
+                if (auto pack = packs.find(uuid); pack != packs.end())
+                    item["version"] = MakeListEntry(*pack->second)["version"];
+                listed.insert(std::move(uuid));
+            }
+        }
+        for (auto node : closure) {
+            auto& dependency = mAddons[node];
+            if (listed.contains(dependency.uuid)) continue;
+            (dependency.type == Addon::Type::ResourcePack ? resourcePackList : behaviorPackList)
+                .push_back(MakeListEntry(dependency));
+        }
+        std::vector<std::pair<fs::path, nlohmann::json>> lists = {
+            {resourcePackListFile, sortList(resourcePackList)},
+            {behaviorPackListFile, sortList(behaviorPackList)}
+        };
+        if (!WriteLists(lists, &failedFile)) throw std::runtime_error("Fail to write data back to addon list file!");
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.addAddonToList.fail", addon.name, failedFile);
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+        return false;
+    }
+    for (auto node : closure) {
+        mAddons[node].enable = true;
+        mLogger.info("ll.addonsHelper.addAddonToList.success", mAddons[node].name);
+    }
+    return true;
+}
+
+void AddonWorld::updateClientPackCache(Addon const& addon, bool force) {
+    if (addon.type != Addon::Type::ResourcePack) return;
+    try {
+        if (mClientPackCache.refresh(addon.uuid, FromUtf8(addon.directory), force))
+            mLogger.debug("ll.addonsHelper.clientPackCache.rebuilt", addon.name);
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.clientPackCache.fail", addon.name);
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+}
+
+void AddonWorld::restoreClientPackCache(Addon const& addon, fs::path const& archive) {
+    if (addon.type != Addon::Type::ResourcePack) return;
+    try {
+        if (!archive.empty() && mClientPackCache.restore(addon.uuid, FromUtf8(addon.directory), archive)) return;
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+    updateClientPackCache(addon);
+}
+
+void AddonWorld::refreshClientPackCache() {
+    // Only the packs that changed since the last refresh get rebuilt
+    std::set<std::string> resourcePacks;
+    for (auto& addon : mAddons) {
+        if (addon.type != Addon::Type::ResourcePack) continue;
+        resourcePacks.insert(addon.uuid);
+        updateClientPackCache(addon);
+    }
+    try {
+        mClientPackCache.prune(resourcePacks);
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+}
+
+bool AddonWorld::installToWorld(PackSource const& pack) {
+    auto addon = readAddon(pack.directory);
+    if (!addon) return false;
+    auto target = mOptions.worldDir / (addon->type == Addon::Type::ResourcePack ? "resource_packs" : "behavior_packs")
+                / FromUtf8(pack.name);
+
+    // An update replaces the installed pack where it is, whatever the new archive is called
+    auto installed =
+        std::find_if(mAddons.begin(), mAddons.end(), [&](Addon const& a) { return a.uuid == addon->uuid; });
+    std::optional<Addon> previous; // put back as it was if the install fails, enabled or not
+    if (installed != mAddons.end()) {
+        target   = FromUtf8(installed->directory);
+        previous = *installed;
+    }
+
+    // Avoid duplicate names or update addon if same uuid
+    while (fs::exists(target)) {
+        auto existing = readAddon(target);
+        if (existing && existing->uuid != addon->uuid) target += "_";
+        else break;
+    }
+
+    // The old version is only replaced once the new one is fully copied, see InstallJournal
+    auto tx = mInstallJournal.begin(addon->uuid, target);
+    try {
+        // Prepared packs already wait next to the world, so staging is a rename
+        mInstallJournal.stage(tx, pack.directory, true);
+        mInstallJournal.swap(tx);
+
+        addon->directory = ToUtf8(target);
+        addon->enable    = true;
+        registerAddon(*addon);
+
+        if (!addToList(*addon)) throw std::runtime_error("Fail to add addon to list file!");
+        mInstallJournal.commit(tx);
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+        mInstallJournal.rollback(tx);
+        // A new pack leaves nothing behind to read
+        if (!previous && fs::exists(target)) previous = readAddon(target);
+        if (previous) registerAddon(*previous);
+        else unregisterAddon(addon->uuid);
+        return false;
+    }
+
+    restoreClientPackCache(*addon, pack.clientArchive);
+    return true;
+}
+
+size_t AddonWorld::reportIssues(std::vector<ValidationIssue> issues, std::vector<PackSource> const& packs) const {
+    for (auto& issue : issues) {
+        for (auto& pack : packs) {
+            auto directory = ToGenericUtf8(pack.directory);
+            if (issue.file.starts_with(directory + "/")) {
+                issue.file = pack.origin + issue.file.substr(directory.size());
+                break;
+            }
+        }
+    }
+    size_t errorCount = 0;
+    for (auto& issue : issues) {
+        auto where = issue.line == 0
+                       ? issue.file
+                       : issue.file + ":" + std::to_string(issue.line) + ":" + std::to_string(issue.column);
+        if (issue.severity == ValidationIssue::Severity::Error) {
+            ++errorCount;
+            mLogger.error("ll.addonsHelper.validate.issue", where, issue.message);
+        } else {
+            mLogger.warn("ll.addonsHelper.validate.issue", where, issue.message);
+        }
+    }
+    return errorCount;
+}
+
+bool AddonWorld::checkAgainstInstalled(std::vector<PackSource> const& packs, std::string const& name) {
+    std::vector<PackValidator::InstalledPack> installed;
+    for (auto& addon : mAddons) installed.push_back({addon.uuid, addon.name, addon.directory, addon.moduleUuids});
+    std::vector<fs::path> packDirs;
+    for (auto& pack : packs) packDirs.push_back(pack.directory);
+
+    if (auto errorCount = reportIssues(mPackValidator.checkManifests(packDirs, installed), packs); errorCount > 0) {
+        mLogger.error("ll.addonsHelper.validate.failed", errorCount, name);
+        return false;
+    }
+    return true;
+}
+
+bool AddonWorld::extract(fs::path const& archive, fs::path const& destination, size_t depth, ZipExtractUsage& usage) {
+    auto name = ToUtf8(archive.filename());
+    if (depth >= mOptions.maxNesting) {
+        mLogger.error("ll.addonsHelper.install.error.nestedTooDeep", name);
+        return false;
+    }
+    try {
+        ExtractZip(archive, destination, mOptions.extractLimits, &usage);
+        return true;
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.install.error.failToUncompress.msg", name);
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+    return false;
+}
+
+// Collect the packs under where, extracting the archives found where there is no manifest, so an archive's packs are
+// all known before any of them is installed. A pack at the root of an archive is named after the archive.
+bool AddonWorld::findManifests(
+    std::vector<PackSource>& result,
+    PackSource const&        where,
+    size_t                   depth,
+    ZipExtractUsage&         usage
+) {
+    std::vector<fs::path> archives;
+    for (auto& file : fs::directory_iterator(where.directory)) {
+        if (IsManifestFile(ToUtf8(file.path().filename()))) {
+            result.push_back(where);
+            return true;
+        }
+        if (file.is_regular_file() && IsAddonArchive(file.path())) archives.push_back(file.path());
+    }
+    if (!archives.empty()) {
+        std::sort(archives.begin(), archives.end());
+        for (auto& archive : archives) {
+            auto destination  = archive;
+            destination      += ".extracted";
+            while (fs::exists(destination)) destination += "_";
+            PackSource nested{destination, ToUtf8(archive.stem()), where.origin + "/" + ToUtf8(archive.filename())};
+            if (!extract(archive, destination, depth + 1, usage) || !findManifests(result, nested, depth + 1, usage))
+                return false;
+        }
+        return true;
+    }
+    for (auto& file : fs::directory_iterator(where.directory)) {
+        if (!file.is_directory()) continue;
+        auto       name = ToUtf8(file.path().filename());
+        PackSource subdirectory{file.path(), name, where.origin + "/" + name};
+        if (!findManifests(result, subdirectory, depth, usage)) return false;
+    }
+    return true;
+}
+
+bool AddonWorld::install(fs::path const& archive, bool removeArchive) {
+    auto prepared = prepareInstall(archive);
+    return prepared && commitInstall(*prepared, removeArchive);
+}
+
+std::optional<AddonWorld::PreparedInstall> AddonWorld::prepareInstall(fs::path const& archive) {
+    std::error_code ec;
+    auto            id        = std::to_string(mNextPreparedId++);
+    auto            extracted = mOptions.tempDir / id;
+    PreparedInstall prepared{archive, mOptions.worldDir / PENDING_DIRECTORY / id, {}};
+    try {
+        if (!fs::exists(archive)) {
+            mLogger.error("ll.addonsHelper.error.addonFileNotFound", archive);
+            return std::nullopt;
+        }
+        if (!IsAddonArchive(archive)) {
+            mLogger.error("ll.addonsHelper.error.unsupportedFileType");
+            return std::nullopt;
+        }
+
+        auto name = ToUtf8(archive.filename());
+        mLogger.warn("ll.addonsHelper.install.installing", name);
+
+        // Every pack, nested archives included, is checked together before the first one is installed. The nested
+        // archives are extracted within the limits of the outer one.
+        std::vector<PackSource> packs;
+        ZipExtractUsage         usage;
+        fs::remove_all(extracted, ec);
+        fs::create_directories(extracted);
+        if (!extract(archive, extracted, 0, usage)
+            || !findManifests(packs, {extracted, ToUtf8(archive.stem()), name}, 0, usage)) {
+            mLogger.error("ll.addonsHelper.error.installationAborted");
+            fs::remove_all(extracted, ec);
+            return std::nullopt;
+        }
+        std::vector<fs::path> packDirs;
+        for (auto& pack : packs) packDirs.push_back(pack.directory);
+        auto issues = mPackValidator.checkFiles(packDirs);
+        mPackValidator.saveCache();
+        if (auto errorCount = reportIssues(std::move(issues), packs); errorCount > 0) {
+            mLogger.error("ll.addonsHelper.validate.failed", errorCount, name);
+            mLogger.error("ll.addonsHelper.error.installationAborted");
+            fs::remove_all(extracted, ec);
+            return std::nullopt;
+        }
+
+        // Copied next to the world, so commitInstall() only has to rename them into place. The client archives of
+        // resource packs are built here too, renames keep them valid for the installed pack.
+        for (size_t i = 0; i < packs.size(); ++i) {
+            PackSource pending{prepared.pending / std::to_string(i), packs[i].name, packs[i].origin};
+            fs::create_directories(pending.directory);
+            fs::copy(packs[i].directory, pending.directory, fs::copy_options::recursive);
+            if (auto addon = readAddon(pending.directory); addon && addon->type == Addon::Type::ResourcePack) {
+                pending.clientArchive = prepared.pending / (std::to_string(i) + ".zip");
+                try {
+                    ClientPackCache::build(pending.directory, pending.clientArchive);
+                } catch (const std::exception& e) {
+                    mLogger.error("ll.addonsHelper.clientPackCache.fail", addon->name);
+                    mLogger.error("ll.addonsHelper.displayError", e.what());
+                    pending.clientArchive.clear();
+                }
+            }
+            prepared.packs.push_back(std::move(pending));
+        }
+        fs::remove_all(extracted, ec);
+        return prepared;
+    } catch (const std::exception& e) {
+        mLogger.error("Uncaught C++ Exception Detected!");
+        mLogger.error("In AddonWorld::install {}", archive);
+        mLogger.error("Error: Code[{}] {}", -1, e.what());
+    } catch (...) {
+        mLogger.error("Uncaught Exception Detected!");
+        mLogger.error("In AddonWorld::install {}", archive);
+    }
+    fs::remove_all(extracted, ec);
+    fs::remove_all(prepared.pending, ec);
+    fs::remove(prepared.pending.parent_path(), ec); // only once no other install is pending
+    return std::nullopt;
+}
+
+bool AddonWorld::commitInstall(PreparedInstall const& prepared, bool removeArchive) {
+    std::error_code ec;
+    bool            installed = false;
+    try {
+        if (!checkAgainstInstalled(prepared.packs, ToUtf8(prepared.archive.filename()))) {
+            mLogger.error("ll.addonsHelper.error.installationAborted");
+        } else {
+            for (auto& pack : prepared.packs) {
+                if (!installToWorld(pack))
+                    throw std::runtime_error("Error in Install Addon To Level ");
+            }
+            if (removeArchive) fs::remove(prepared.archive, ec);
+            installed = true;
+        }
+    } catch (const std::exception& e) {
+        mLogger.error("Uncaught C++ Exception Detected!");
+        mLogger.error("In AddonWorld::install {}", prepared.archive);
+        mLogger.error("Error: Code[{}] {}", -1, e.what());
+    } catch (...) {
+        mLogger.error("Uncaught Exception Detected!");
+        mLogger.error("In AddonWorld::install {}", prepared.archive);
+    }
+    fs::remove_all(prepared.pending, ec);
+    fs::remove(prepared.pending.parent_path(), ec);
+    return installed;
+}
+
+bool AddonWorld::installDirectory(fs::path const& directory, bool removeArchives) {
+    std::error_code       ec;
+    std::vector<fs::path> toInstallList;
+    for (auto& file : fs::directory_iterator(directory, ec)) {
+        if (!file.is_regular_file()) continue;
+        if (IsAddonArchive(file.path())) toInstallList.push_back(file.path().lexically_normal());
+    }
+    if (toInstallList.empty()) return false;
+    std::sort(toInstallList.begin(), toInstallList.end());
+
+    mLogger.info("ll.addonsHelper.autoInstall.working", toInstallList.size());
+    int cnt = 0;
+    for (auto& addonPath : toInstallList) {
+        mLogger.debug("Installing \"{}\"...", addonPath);
+        if (!install(addonPath, removeArchives)) break;
+        ++cnt;
+        mLogger.info("ll.addonsHelper.autoInstall.installed", addonPath);
+    }
+
+    if (cnt == 0) mLogger.error("ll.addonsHelper.error.noAddonInstalled");
+    else mLogger.info("ll.addonsHelper.autoInstall.installedCount", cnt);
+    return true;
+}
+
+bool AddonWorld::disable(std::string const& nameOrUuid) {
+    try {
+        auto addon = find(nameOrUuid, true);
+        if (!addon) return false;
+        if (removeFromList(*addon)) {
+            addon->enable = false;
+            return true;
+        }
+    } catch (...) {}
+    return false;
+}
+
+bool AddonWorld::enable(std::string const& nameOrUuid, bool withDependencies) {
+    try {
+        auto addon = find(nameOrUuid, true);
+        if (!addon) return false;
+        if (withDependencies) return addWithDependenciesToList(*addon);
+        if (addToList(*addon)) {
+            addon->enable = true;
+            return true;
+        }
+    } catch (...) {}
+    return false;
+}
+
+bool AddonWorld::rollback(std::string const& nameOrUuid, std::string version) {
+    try {
+        auto addon = find(nameOrUuid, true);
+        if (!addon) {
+            mLogger.error("ll.addonsHelper.error.addonNotFound", nameOrUuid);
+            return false;
+        }
+        auto versions = mPackSnapshots.versions(addon->uuid);
+        if (versions.empty()) {
+            mLogger.error("ll.addonsHelper.rollback.noSnapshot", addon->name);
+            return false;
+        }
+        // Versions are listed as v1.0.0, accept them written either way
+        if (version.starts_with('v') || version.starts_with('V')) version.erase(0, 1);
+        if (version.empty()) version = versions.front();
+        if (std::find(versions.begin(), versions.end(), version) == versions.end()) {
+            std::string available;
+            for (auto& v : versions) available += (available.empty() ? "v" : ", v") + v;
+            mLogger.error("ll.addonsHelper.rollback.versionNotFound", addon->name, version, available);
+            return false;
+        }
+
+        // Same path as an install, except the snapshot is moved into staging instead of copied, and the replaced
+        // version becomes a snapshot itself when the journal retires it. A rollback of the journal moves the
+        // snapshot back into the store, so it is only forgotten once the pack is listed.
+        std::string uuid      = addon->uuid;
+        std::string directory = addon->directory;
+        bool        enabled   = addon->enable;
+        auto        archive   = mPackSnapshots.archivePath(uuid, version);
+        auto        tx        = mInstallJournal.begin(uuid, FromUtf8(directory));
+        try {
+            mInstallJournal.stage(tx, mPackSnapshots.path(uuid, version), true);
+            mInstallJournal.swap(tx);
+
+            auto restored = readAddon(tx.target);
+            if (!restored) throw std::runtime_error("Invalid addon snapshot!");
+            restored->directory = directory;
+            restored->enable    = enabled;
+            registerAddon(*restored);
+            if (enabled && !addToList(*restored)) throw std::runtime_error("Fail to add addon to list file!");
+            mPackSnapshots.forget(uuid, version);
+            mInstallJournal.commit(tx);
+
+            // The client archive kept with the snapshot still matches it, only build one if there is none
+            restoreClientPackCache(*restored, archive);
+            mLogger.info("ll.addonsHelper.rollback.success", restored->name, version);
+            return true;
+        } catch (const std::exception& e) {
+            mLogger.error("ll.addonsHelper.displayError", e.what());
+            mInstallJournal.rollback(tx);
+            if (auto previous = readAddon(tx.target)) {
+                previous->directory = directory;
+                previous->enable    = enabled;
+                registerAddon(*previous);
+            }
+        }
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+    return false;
+}
+
+bool AddonWorld::uninstall(std::string const& nameOrUuid) {
+    try {
+        auto addon = find(nameOrUuid, true);
+        if (!addon) {
+            mLogger.error("ll.addonsHelper.error.addonNotFound", nameOrUuid);
+            return false;
+        }
+        std::string addonName = addon->name;
+        removeFromList(*addon);
+        if (addon->type == Addon::Type::ResourcePack) mClientPackCache.remove(addon->uuid);
+        mPackSnapshots.drop(addon->uuid);
+        std::error_code ec;
+        fs::remove_all(FromUtf8(addon->directory), ec);
+        unregisterAddon(addon->uuid);
+        mLogger.info("ll.addonsHelper.uninstall.success", addonName);
+        return true;
+    } catch (...) {}
+    return false;
+}
+
+size_t AddonWorld::verify() {
+    std::vector<fs::path> packDirs;
+    for (auto& addon : mAddons) packDirs.push_back(FromUtf8(addon.directory));
+    auto errorCount = reportIssues(mPackValidator.validate(packDirs, {}));
+    mPackValidator.saveCache();
+
+    // Listed packs that aren't in the world may still come from the server's own pack folders, so only warn
+    for (auto type : {Addon::Type::ResourcePack, Addon::Type::BehaviorPack}) {
+        auto file    = listFile(type);
+        auto content = ReadFile(file);
+        if (!content) continue;
+        auto list = nlohmann::json::parse(*content, nullptr, false, true);
+        if (!list.is_array() || !std::all_of(list.begin(), list.end(), IsListEntry)) {
+            ++errorCount;
+            mLogger.error("ll.addonsHelper.verify.invalidList", file);
+            continue;
+        }
+        for (auto& item : list) {
+            std::string uuid = item["pack_id"];
+            if (std::none_of(mAddons.begin(), mAddons.end(), [&](Addon const& a) { return a.uuid == uuid; }))
+                mLogger.warn("ll.addonsHelper.verify.notInstalled", file.filename(), uuid);
+        }
+    }
+
+    if (errorCount > 0) mLogger.error("ll.addonsHelper.verify.failed", errorCount, mOptions.worldDir.filename());
+    else mLogger.info("ll.addonsHelper.verify.passed", mAddons.size(), mOptions.worldDir.filename());
+    return errorCount;
+}
+
+Addon* AddonWorld::find(std::string const& nameOrUuid, bool fuzzy) {
+    Addon* possible   = nullptr;
+    bool   multiMatch = false;
+    auto   targetName = RemoveEscapeCode(nameOrUuid);
+    for (auto& addon : mAddons) {
+        if (addon.uuid == nameOrUuid) return &addon;
+        auto addonName = RemoveEscapeCode(addon.name);
+        if (addonName == targetName) return &addon;
+        if (!fuzzy) continue;
+        // Simple fuzzy matching
+        auto lowerTarget = targetName;
+        std::transform(addonName.begin(), addonName.end(), addonName.begin(), ::tolower);
+        std::transform(lowerTarget.begin(), lowerTarget.end(), lowerTarget.begin(), ::tolower);
+        if (addonName.starts_with(lowerTarget)) {
+            if (possible) multiMatch = true;
+            else possible = &addon;
+        }
+    }
+    if (multiMatch) return nullptr;
+    else return possible;
+}
+
+std::vector<SearchIndex::Result> AddonWorld::search(std::string_view query, size_t limit) const {
+    return mSearchIndex.search(query, limit);
+}
+
+void AddonWorld::findAddons(fs::path const& listFile, fs::path const& packsDir) {
+    try {
+        if (!fs::exists(listFile) && !fs::exists(packsDir)) return;
+        if (!fs::exists(packsDir)) fs::create_directories(packsDir);
+
+        auto content = ReadFile(listFile).value_or("");
+        if (content.empty()) {
+            WriteFile(listFile, "[]");
+            content = "[]";
+        }
+        std::set<std::string> validPackIDs;
+        try {
+            auto list = nlohmann::json::parse(content, nullptr, true, true);
+            for (auto& item : list) validPackIDs.insert(item["pack_id"].get<std::string>());
+        } catch (const std::exception&) {
+            mLogger.error("ll.addonsHelper.error.parsingEnabledAddonsList");
+        }
+
+        for (auto& dir : fs::directory_iterator(packsDir)) {
+            // Hidden directories are the staging and backup copies of the install journal
+            if (!dir.is_directory() || ToUtf8(dir.path().filename()).starts_with('.')) continue;
+            auto addon = readAddon(dir.path());
+            if (!addon) continue;
+            if (validPackIDs.contains(addon->uuid)) addon->enable = true;
+            mSearchIndex.add(addon->uuid, addon->name, addon->description);
+            mAddons.emplace_back(std::move(*addon));
+        }
+    } catch (...) {
+        return;
+    }
+}
+
+void AddonWorld::recoverInterruptedInstalls() {
+    try {
+        auto recovered = mInstallJournal.recover([this](InstallJournal::Transaction const& tx) {
+            auto addon = readAddon(tx.target);
+            return addon.has_value() && addToList(*addon);
+        });
+        for (auto& [tx, outcome] : recovered) {
+            if (outcome == InstallJournal::Outcome::RolledForward)
+                mLogger.warn("ll.addonsHelper.journal.rolledForward", tx.target.filename());
+            else mLogger.warn("ll.addonsHelper.journal.rolledBack", tx.target.filename());
+        }
+    } catch (const std::exception& e) {
+        mLogger.error("ll.addonsHelper.journal.fail");
+        mLogger.error("ll.addonsHelper.displayError", e.what());
+    }
+}
+
+void AddonWorld::load() {
+    // Temp only holds extracted archives, the state of interrupted installs is in the journal
+    std::error_code ec;
+    fs::remove_all(mOptions.tempDir, ec);
+    fs::create_directories(mOptions.tempDir, ec);
+
+    recoverInterruptedInstalls();
+    // Whatever an interrupted install moved back is no longer wanted
+    fs::remove_all(mOptions.worldDir / PENDING_DIRECTORY, ec);
+
+    mAddons.clear();
+    mSearchIndex.clear();
+    mReportedCycles.clear();
+    findAddons(listFile(Addon::Type::BehaviorPack), mOptions.worldDir / "behavior_packs");
+    findAddons(listFile(Addon::Type::ResourcePack), mOptions.worldDir / "resource_packs");
+
+    std::sort(mAddons.begin(), mAddons.end(), [](Addon const& _Left, Addon const& _Right) {
+        if (_Left.enable && !_Right.enable) return true;
+        if (_Left.type == Addon::Type::ResourcePack && _Right.type == Addon::Type::BehaviorPack) return true;
+        return false;
+    });
+    rebuildDependencyGraph();
+}
+
+} // namespace legacy_addons_manager
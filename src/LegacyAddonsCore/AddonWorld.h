@@ -0,0 +1,137 @@
+#pragma once
+
+#include "Addon.h"
+#include "ClientPackCache.h"
+#include "DependencyGraph.h"
+#include "InstallJournal.h"
+#include "Logger.h"
+#include "PackSnapshots.h"
+#include "PackValidator.h"
+#include "SearchIndex.h"
+#include "ZipArchive.h"
+#include "nlohmann/json.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// .mcpack, .mcaddon or .zip
+bool IsAddonArchive(std::filesystem::path const& path);
+
+// The packs installed in one world directory, its world pack lists and the stores kept next to them. Nothing here
+// needs a running server, so the mod and the offline CLI share it. Not thread safe: one instance per world, used by
+// one thread at a time, except for prepareInstall() which may run alongside that thread.
+class AddonWorld {
+public:
+    struct PackSource {
+        std::filesystem::path directory;
+        std::string           name;               // of the directory it is installed to
+        std::string           origin;             // the archive and directories it was found in, for messages
+        std::filesystem::path clientArchive = {}; // of a prepared resource pack, built outside the world lock
+    };
+
+    // An archive extracted and checked, its packs waiting next to the world to be renamed into place
+    struct PreparedInstall {
+        std::filesystem::path   archive;
+        std::filesystem::path   pending;
+        std::vector<PackSource> packs;
+    };
+
+    struct Options {
+        std::filesystem::path worldDir;
+        std::filesystem::path tempDir;             // archives are extracted here, wiped by load()
+        std::filesystem::path validationCacheFile; // empty to keep validation results in memory only
+        size_t                snapshotKeep = 3;
+        size_t                maxNesting   = 4; // archives inside archives
+        ZipExtractLimits      extractLimits;
+    };
+
+    AddonWorld(Options options, Logger logger);
+
+    AddonWorld(AddonWorld const&)            = delete;
+    AddonWorld& operator=(AddonWorld const&) = delete;
+
+    // Recover installs interrupted by a crash, then read the installed packs. Call before anything else.
+    void load();
+    // Rebuild the client download archives of the resource packs that changed, and drop those of removed packs
+    void refreshClientPackCache();
+
+    bool install(std::filesystem::path const& archive, bool removeArchive = true);
+    // install() in two halves. prepareInstall() extracts the archive and checks its files without reading the world,
+    // the expensive part; commitInstall() checks the packs against the installed ones and swaps them in.
+    std::optional<PreparedInstall> prepareInstall(std::filesystem::path const& archive);
+    bool                           commitInstall(PreparedInstall const& prepared, bool removeArchive = true);
+    // Install the archives directly inside directory, stopping at the first failure. Returns false if there was
+    // nothing to install.
+    bool installDirectory(std::filesystem::path const& directory, bool removeArchives = true);
+    bool uninstall(std::string const& nameOrUuid);
+
+    bool enable(std::string const& nameOrUuid, bool withDependencies = false);
+    bool disable(std::string const& nameOrUuid);
+
+    // Swap in a retained previous version, the most recent one if version is empty
+    bool rollback(std::string const& nameOrUuid, std::string version = "");
+
+    // Check the installed packs and the world pack lists without changing them. Returns the number of errors.
+    size_t verify();
+
+    [[nodiscard]] std::filesystem::path const& directory() const { return mOptions.worldDir; }
+    [[nodiscard]] Logger const&                logger() const { return mLogger; }
+    [[nodiscard]] std::vector<Addon>&          addons() { return mAddons; }
+    [[nodiscard]] Addon*                       find(std::string const& nameOrUuid, bool fuzzy = false);
+    [[nodiscard]] std::vector<SearchIndex::Result> search(std::string_view query, size_t limit) const;
+
+private:
+    std::filesystem::path listFile(Addon::Type type) const;
+    std::optional<Addon>  readAddon(std::filesystem::path const& addonPath) const;
+
+    void registerAddon(Addon addon);
+    void unregisterAddon(std::string const& uuid);
+    void rebuildDependencyGraph();
+
+    nlohmann::json readList(std::filesystem::path const& file) const;
+    nlohmann::json sortList(nlohmann::json const& list) const;
+    bool           removeFromList(Addon& addon);
+    bool           addToList(Addon& addon);
+    bool           addWithDependenciesToList(Addon& addon);
+
+    void findAddons(std::filesystem::path const& listFile, std::filesystem::path const& packsDir);
+    bool extract(
+        std::filesystem::path const& archive,
+        std::filesystem::path const& destination,
+        size_t                       depth,
+        ZipExtractUsage&             usage
+    );
+    bool findManifests(std::vector<PackSource>& result, PackSource const& where, size_t depth, ZipExtractUsage& usage);
+    bool checkAgainstInstalled(std::vector<PackSource> const& packs, std::string const& name);
+    // Packs being installed only exist in temporary directories, their issues are reported against their origin
+    size_t reportIssues(std::vector<ValidationIssue> issues, std::vector<PackSource> const& packs = {}) const;
+    bool   installToWorld(PackSource const& pack);
+    void   updateClientPackCache(Addon const& addon, bool force = false);
+    // Move an archive built ahead into the client pack cache, or build one if that fails
+    void   restoreClientPackCache(Addon const& addon, std::filesystem::path const& archive);
+    void   recoverInterruptedInstalls();
+
+    Options            mOptions;
+    Logger             mLogger;
+    std::vector<Addon> mAddons;
+
+    std::atomic<std::uint64_t> mNextPreparedId = 0;
+
+    ClientPackCache       mClientPackCache;
+    PackValidator         mPackValidator;
+    InstallJournal        mInstallJournal;
+    PackSnapshots         mPackSnapshots;
+    DependencyGraph       mDependencyGraph; // node indices match mAddons
+    std::set<std::string> mReportedCycles;  // already logged, as "a -> b -> a"
+    SearchIndex           mSearchIndex;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,230 @@
+#include "ClientPackCache.h"
+#include "Sha256.h"
+#include "StringUtils.h"
+#include "ZipArchive.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct PackFile {
+    std::string   name;
+    fs::path      path;
+    std::uint64_t size;
+    std::int64_t  mtime;
+};
+
+std::vector<PackFile> ListPackFiles(fs::path const& packDir) {
+    std::vector<PackFile> files;
+    for (auto& entry : fs::recursive_directory_iterator(packDir)) {
+        if (!entry.is_regular_file()) continue;
+        files.push_back(
+            {ToGenericUtf8(entry.path().lexically_relative(packDir)),
+             entry.path(),
+             entry.file_size(),
+             std::int64_t(entry.last_write_time().time_since_epoch().count())}
+        );
+    }
+    // The manifest goes first so clients can read the pack header without walking the whole archive
+    std::sort(files.begin(), files.end(), [](PackFile const& l, PackFile const& r) {
+        bool lManifest = l.name == "manifest.json", rManifest = r.name == "manifest.json";
+        if (lManifest != rManifest) return lManifest;
+        return l.name < r.name;
+    });
+    return files;
+}
+
+std::string Fingerprint(std::vector<PackFile> const& files) {
+    Sha256 sha;
+    for (auto& file : files) {
+        sha.update(file.name).update("\0", 1);
+        sha.update(&file.size, sizeof(file.size)).update(&file.mtime, sizeof(file.mtime));
+    }
+    return Sha256::toHex(sha.finish());
+}
+
+std::string ReadBinaryFile(fs::path const& path) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) throw std::runtime_error("Fail to open " + ToGenericUtf8(path));
+    std::ostringstream oss;
+    oss << fin.rdbuf();
+    return std::move(oss).str();
+}
+
+std::string HashFile(fs::path const& path) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) throw std::runtime_error("Fail to open " + ToGenericUtf8(path));
+    Sha256 sha;
+    char   buffer[65536];
+    while (fin.read(buffer, sizeof(buffer)) || fin.gcount() > 0) sha.update(buffer, size_t(fin.gcount()));
+    return Sha256::toHex(sha.finish());
+}
+
+// Write the archive of the files and its checksum next to it. Returns the checksum.
+std::string WriteArchive(std::vector<PackFile> const& files, fs::path const& archive) {
+    auto tmpPath  = archive;
+    tmpPath      += ".tmp";
+    try {
+        ZipWriter writer(tmpPath);
+        for (auto& file : files) writer.add(file.name, ReadBinaryFile(file.path));
+        writer.finish();
+    } catch (...) {
+        std::error_code ec;
+        fs::remove(tmpPath, ec);
+        throw;
+    }
+    auto sha256 = HashFile(tmpPath);
+    fs::rename(tmpPath, archive);
+
+    auto checksumPath = archive;
+    checksumPath     += ".sha256";
+    std::ofstream(checksumPath, std::ios::binary | std::ios::trunc)
+        << sha256 << "  " << ToGenericUtf8(archive.filename()) << "\n";
+    return sha256;
+}
+
+} // namespace
+
+ClientPackCache::ClientPackCache(fs::path directory) : mDirectory(std::move(directory)) { loadIndex(); }
+
+fs::path ClientPackCache::archivePath(std::string const& uuid) const {
+    // uuids come from third-party manifests, never use them as a file name unchecked
+    return mDirectory / ((IsSafeFileName(uuid) ? uuid : Sha256::hash(uuid)) + ".zip");
+}
+
+ClientPackCache::Entry const* ClientPackCache::find(std::string const& uuid) const {
+    auto it = mEntries.find(uuid);
+    return it == mEntries.end() ? nullptr : &it->second;
+}
+
+bool ClientPackCache::refresh(std::string const& uuid, fs::path const& packDir, bool force) {
+    auto files       = ListPackFiles(packDir);
+    auto fingerprint = Fingerprint(files);
+    auto archive     = archivePath(uuid);
+
+    auto it = mEntries.find(uuid);
+    if (!force && it != mEntries.end() && it->second.fingerprint == fingerprint && fs::exists(archive)) return false;
+
+    fs::create_directories(mDirectory);
+    Entry entry;
+    entry.fingerprint = std::move(fingerprint);
+    entry.sha256      = WriteArchive(files, archive);
+    entry.size        = fs::file_size(archive);
+
+    mEntries[uuid] = std::move(entry);
+    saveIndex();
+    return true;
+}
+
+void ClientPackCache::build(fs::path const& packDir, fs::path const& archive) {
+    WriteArchive(ListPackFiles(packDir), archive);
+}
+
+void ClientPackCache::remove(std::string const& uuid) {
+    auto archive      = archivePath(uuid);
+    auto checksumPath = archive;
+    checksumPath     += ".sha256";
+    std::error_code ec;
+    fs::remove(archive, ec);
+    fs::remove(checksumPath, ec);
+    if (mEntries.erase(uuid) > 0) saveIndex();
+}
+
+bool ClientPackCache::stash(std::string const& uuid, fs::path const& packDir, fs::path const& destination) {
+    auto it      = mEntries.find(uuid);
+    auto archive = archivePath(uuid);
+    if (it == mEntries.end() || !fs::exists(archive) || it->second.fingerprint != Fingerprint(ListPackFiles(packDir)))
+        return false;
+
+    auto checksumPath = archive;
+    checksumPath     += ".sha256";
+    auto stashedPath  = destination;
+    stashedPath      += ".sha256";
+    fs::create_directories(destination.parent_path());
+    fs::rename(archive, destination);
+    std::error_code ec;
+    fs::rename(checksumPath, stashedPath, ec);
+
+    mEntries.erase(it);
+    saveIndex();
+    return true;
+}
+
+bool ClientPackCache::restore(std::string const& uuid, fs::path const& packDir, fs::path const& archive) {
+    if (!fs::exists(archive)) return false;
+    auto stashedPath  = archive;
+    stashedPath      += ".sha256";
+
+    // Renames keep the mtimes, so the fingerprint of the restored pack matches the one it was archived with
+    Entry entry;
+    entry.fingerprint = Fingerprint(ListPackFiles(packDir));
+    std::ifstream(stashedPath) >> entry.sha256;
+    if (entry.sha256.empty()) entry.sha256 = HashFile(archive);
+    entry.size = fs::file_size(archive);
+
+    auto target       = archivePath(uuid);
+    auto checksumPath = target;
+    checksumPath     += ".sha256";
+    fs::create_directories(mDirectory);
+    fs::rename(archive, target);
+    std::error_code ec;
+    fs::remove(stashedPath, ec);
+    std::ofstream(checksumPath, std::ios::binary | std::ios::trunc)
+        << entry.sha256 << "  " << ToGenericUtf8(target.filename()) << "\n";
+
+    mEntries[uuid] = std::move(entry);
+    saveIndex();
+    return true;
+}
+
+void ClientPackCache::prune(std::set<std::string> const& installedUuids) {
+    std::vector<std::string> stale;
+    for (auto& [uuid, entry] : mEntries)
+        if (!installedUuids.contains(uuid)) stale.push_back(uuid);
+    for (auto& uuid : stale) remove(uuid);
+}
+
+void ClientPackCache::loadIndex() {
+    mEntries.clear();
+    std::ifstream fin(mDirectory / "index.json");
+    if (!fin) return;
+    auto index = nlohmann::json::parse(fin, nullptr, false);
+    if (!index.is_object()) return;
+    for (auto& [uuid, data] : index.items()) {
+        if (!data.is_object()) continue;
+        Entry entry;
+        entry.fingerprint = data.value("fingerprint", "");
+        entry.sha256      = data.value("sha256", "");
+        entry.size        = data.value("size", std::uint64_t(0));
+        mEntries.emplace(uuid, std::move(entry));
+    }
+}
+
+void ClientPackCache::saveIndex() const {
+    auto index = nlohmann::json::object();
+    for (auto& [uuid, entry] : mEntries) {
+        index[uuid] = {
+            {"fingerprint", entry.fingerprint},
+            {"sha256",      entry.sha256     },
+            {"size",        entry.size       }
+        };
+    }
+    auto tmpPath = mDirectory / "index.json.tmp";
+    {
+        std::ofstream fout(tmpPath, std::ios::binary | std::ios::trunc);
+        fout << index.dump(4);
+        if (!fout) throw std::runtime_error("Fail to write client pack cache index");
+    }
+    fs::rename(tmpPath, mDirectory / "index.json");
+}
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+
+namespace legacy_addons_manager {
+
+// Keeps a ready-to-serve ZIP of every installed resource pack, so client downloads don't have to package the pack on
+// the fly. Archives are deterministic (sorted entries, fixed timestamps) and only rebuilt when the pack changes.
+class ClientPackCache {
+public:
+    struct Entry {
+        std::string   fingerprint; // digest of the pack's file list, sizes and mtimes
+        std::string   sha256;      // digest of the archive itself
+        std::uint64_t size = 0;
+    };
+
+    explicit ClientPackCache(std::filesystem::path directory);
+
+    [[nodiscard]] std::filesystem::path archivePath(std::string const& uuid) const;
+    [[nodiscard]] Entry const*          find(std::string const& uuid) const;
+
+    // Rebuild the archive of the pack if its contents changed since the last build. Returns whether it was rebuilt.
+    bool refresh(std::string const& uuid, std::filesystem::path const& packDir, bool force = false);
+    // Build the archive of a pack that isn't installed yet, to restore() it once it is. Touches nothing but archive
+    // and its checksum, so it can run alongside the cache's own thread.
+    static void build(std::filesystem::path const& packDir, std::filesystem::path const& archive);
+    void remove(std::string const& uuid);
+    // Move the archive out of the cache to destination, with its checksum, if it is up to date with packDir. Returns
+    // whether it was moved.
+    bool stash(std::string const& uuid, std::filesystem::path const& packDir, std::filesystem::path const& destination);
+    // Move an archive stashed from packDir, or built from it by build(), into the cache. Returns false if there is
+    // nothing to move.
+    bool restore(std::string const& uuid, std::filesystem::path const& packDir, std::filesystem::path const& archive);
+    // Drop the archives of every pack not in installedUuids
+    void prune(std::set<std::string> const& installedUuids);
+
+private:
+    void loadIndex();
+    void saveIndex() const;
+
+    std::filesystem::path        mDirectory;
+    std::map<std::string, Entry> mEntries;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,118 @@
+#include "DependencyGraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace legacy_addons_manager {
+
+DependencyGraph::DependencyGraph(std::vector<Pack> const& packs) {
+    mUuids.reserve(packs.size());
+    for (size_t i = 0; i < packs.size(); ++i) {
+        mUuids.push_back(packs[i].uuid);
+        mIndex.emplace(packs[i].uuid, i);
+    }
+    mEdges.resize(packs.size());
+    mMissing.resize(packs.size());
+    for (size_t i = 0; i < packs.size(); ++i) {
+        for (auto& dependency : packs[i].dependencies) {
+            if (auto it = mIndex.find(dependency); it != mIndex.end()) mEdges[i].push_back(it->second);
+            else mMissing[i].push_back(dependency);
+        }
+    }
+}
+
+std::optional<size_t> DependencyGraph::indexOf(std::string const& uuid) const {
+    auto it = mIndex.find(uuid);
+    if (it == mIndex.end()) return std::nullopt;
+    return it->second;
+}
+
+std::vector<size_t> DependencyGraph::closure(size_t index, std::vector<std::string>* missing) const {
+    std::vector<bool>   visited(mUuids.size(), false);
+    std::vector<size_t> res{index};
+    visited[index] = true;
+    for (size_t i = 0; i < res.size(); ++i) {
+        if (missing) missing->insert(missing->end(), mMissing[res[i]].begin(), mMissing[res[i]].end());
+        for (auto dependency : mEdges[res[i]]) {
+            if (visited[dependency]) continue;
+            visited[dependency] = true;
+            res.push_back(dependency);
+        }
+    }
+    return res;
+}
+
+std::vector<std::vector<std::string>> DependencyGraph::findCycles() const {
+    enum class State { Unvisited, InStack, Done };
+    std::vector<State>                    states(mUuids.size(), State::Unvisited);
+    std::vector<size_t>                   stack;
+    std::vector<std::vector<std::string>> cycles;
+
+    // Iterative DFS, the stack of (node, next edge) pairs mirrors the current path
+    for (size_t root = 0; root < mUuids.size(); ++root) {
+        if (states[root] != State::Unvisited) continue;
+        std::vector<std::pair<size_t, size_t>> frames;
+        frames.emplace_back(root, 0);
+        states[root] = State::InStack;
+        stack.push_back(root);
+        while (!frames.empty()) {
+            auto& [node, edge] = frames.back();
+            if (edge == mEdges[node].size()) {
+                states[node] = State::Done;
+                stack.pop_back();
+                frames.pop_back();
+                continue;
+            }
+            auto next = mEdges[node][edge++];
+            if (states[next] == State::Unvisited) {
+                states[next] = State::InStack;
+                stack.push_back(next);
+                frames.emplace_back(next, 0);
+            } else if (states[next] == State::InStack) {
+                std::vector<std::string> cycle;
+                for (auto it = std::find(stack.begin(), stack.end(), next); it != stack.end(); ++it)
+                    cycle.push_back(mUuids[*it]);
+                cycles.push_back(std::move(cycle));
+            }
+        }
+    }
+    return cycles;
+}
+
+std::vector<std::string> DependencyGraph::order(std::vector<std::string> const& uuids) const {
+    // Kahn's algorithm on the subgraph of the listed packs, always emitting the ready pack listed first
+    std::unordered_map<size_t, size_t> position; // node -> position in uuids
+    for (size_t i = 0; i < uuids.size(); ++i)
+        if (auto node = indexOf(uuids[i])) position.emplace(*node, i);
+
+    std::vector<size_t> dependents(uuids.size(), 0);
+    for (auto& [node, pos] : position)
+        for (auto dependency : mEdges[node])
+            if (auto it = position.find(dependency); it != position.end()) ++dependents[it->second];
+
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<>> ready;
+    for (size_t i = 0; i < uuids.size(); ++i)
+        if (dependents[i] == 0) ready.push(i);
+
+    std::vector<std::string> res;
+    std::vector<bool>        emitted(uuids.size(), false);
+    res.reserve(uuids.size());
+    while (!ready.empty()) {
+        auto pos = ready.top();
+        ready.pop();
+        emitted[pos] = true;
+        res.push_back(uuids[pos]);
+        auto node = indexOf(uuids[pos]);
+        if (!node) continue;
+        for (auto dependency : mEdges[*node])
+            if (auto it = position.find(dependency); it != position.end() && --dependents[it->second] == 0)
+                ready.push(it->second);
+    }
+    // Whatever is left is part of or behind a cycle
+    for (size_t i = 0; i < uuids.size(); ++i)
+        if (!emitted[i]) res.push_back(uuids[i]);
+    return res;
+}
+
+} // namespace legacy_addons_manager
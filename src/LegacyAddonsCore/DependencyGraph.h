@@ -0,0 +1,43 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Dependency graph of the installed packs, indexed by header uuid. Node indices match the order of the packs passed
+// to the constructor.
+class DependencyGraph {
+public:
+    struct Pack {
+        std::string              uuid;
+        std::vector<std::string> dependencies;
+    };
+
+    DependencyGraph() = default;
+    explicit DependencyGraph(std::vector<Pack> const& packs);
+
+    [[nodiscard]] std::optional<size_t> indexOf(std::string const& uuid) const;
+
+    // The pack and everything it transitively depends on, in O(V + E). Dependencies that are not installed are
+    // appended to missing.
+    [[nodiscard]] std::vector<size_t> closure(size_t index, std::vector<std::string>* missing = nullptr) const;
+
+    // Every dependency cycle, as the uuids along the cycle
+    [[nodiscard]] std::vector<std::vector<std::string>> findCycles() const;
+
+    // Reorder the uuids of a world pack list so that every pack comes before the packs it depends on (the top of the
+    // list has the highest priority, so a pack overrides its dependencies). Otherwise the current order is kept.
+    // Unknown uuids and packs in a cycle stay where they are relative to each other.
+    [[nodiscard]] std::vector<std::string> order(std::vector<std::string> const& uuids) const;
+
+private:
+    std::vector<std::string>                mUuids;
+    std::vector<std::vector<size_t>>        mEdges;   // pack -> installed dependencies
+    std::vector<std::vector<std::string>>   mMissing; // pack -> dependencies that aren't installed
+    std::unordered_map<std::string, size_t> mIndex;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,218 @@
+#include "DirectoryWatcher.h"
+#include "StringUtils.h"
+
+#include <set>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+#ifdef _WIN32
+
+// ReadDirectoryChangesW on the directory, one overlapped read kept in flight
+struct DirectoryWatcher::Native {
+    HANDLE     directory = INVALID_HANDLE_VALUE;
+    OVERLAPPED overlapped{};
+    bool       reading = false;
+    alignas(DWORD) std::byte buffer[64 * 1024];
+
+    explicit Native(fs::path const& path) {
+        directory = CreateFileW(
+            path.c_str(),
+            FILE_LIST_DIRECTORY,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+            nullptr
+        );
+        if (directory == INVALID_HANDLE_VALUE) throw std::runtime_error("Fail to watch " + ToUtf8(path));
+        overlapped.hEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    }
+
+    ~Native() {
+        if (reading) {
+            DWORD bytes = 0;
+            CancelIoEx(directory, &overlapped);
+            GetOverlappedResult(directory, &overlapped, &bytes, TRUE);
+        }
+        if (overlapped.hEvent) CloseHandle(overlapped.hEvent);
+        CloseHandle(directory);
+    }
+
+    // Names of the changed entries, empty on timeout. nullopt if notifications were lost and the directory has to be
+    // listed instead. Throws std::runtime_error if the directory can't be watched anymore.
+    std::optional<std::vector<fs::path>> wait(std::chrono::milliseconds timeout) {
+        if (!reading) {
+            constexpr DWORD FILTER =
+                FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+            if (!ReadDirectoryChangesW(directory, buffer, sizeof(buffer), FALSE, FILTER, nullptr, &overlapped, nullptr))
+                throw std::runtime_error("ReadDirectoryChangesW failed");
+            reading = true;
+        }
+        if (WaitForSingleObject(overlapped.hEvent, static_cast<DWORD>(timeout.count())) != WAIT_OBJECT_0)
+            return std::vector<fs::path>{};
+        reading     = false;
+        DWORD bytes = 0;
+        if (!GetOverlappedResult(directory, &overlapped, &bytes, FALSE) || bytes == 0) return std::nullopt;
+
+        std::vector<fs::path> res;
+        for (auto* pos = buffer;;) {
+            auto* info = reinterpret_cast<FILE_NOTIFY_INFORMATION const*>(pos);
+            res.emplace_back(std::wstring(info->FileName, info->FileNameLength / sizeof(WCHAR)));
+            if (info->NextEntryOffset == 0) break;
+            pos += info->NextEntryOffset;
+        }
+        return res;
+    }
+};
+
+#else
+
+struct DirectoryWatcher::Native {
+    explicit Native(fs::path const&) { throw std::runtime_error("No change notifications on this platform"); }
+
+    std::optional<std::vector<fs::path>> wait(std::chrono::milliseconds) { return std::nullopt; }
+};
+
+#endif
+
+DirectoryWatcher::DirectoryWatcher(fs::path directory, Options options, Handler onSettled)
+: mDirectory(std::move(directory)),
+  mOptions(std::move(options)),
+  mHandler(std::move(onSettled)) {
+    std::error_code ec;
+    for (auto& entry : fs::directory_iterator(mDirectory, ec))
+        if (auto state = stat(entry.path())) mKnown[entry.path()] = *state;
+}
+
+DirectoryWatcher::~DirectoryWatcher() { stop(); }
+
+void DirectoryWatcher::start() {
+    if (mThread.joinable()) return;
+    mPending.clear();
+
+    mNative.reset();
+    if (!mOptions.forcePolling) {
+        try {
+            mNative = std::make_unique<Native>(mDirectory);
+        } catch (const std::exception&) {}
+    }
+    mStopping = false;
+    mThread   = std::thread([this] { run(); });
+}
+
+void DirectoryWatcher::stop() {
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mStopped.notify_all();
+    if (mThread.joinable()) mThread.join();
+    mNative.reset();
+}
+
+std::optional<DirectoryWatcher::State> DirectoryWatcher::stat(fs::path const& path) const {
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec) || (mOptions.filter && !mOptions.filter(path))) return std::nullopt;
+    State state;
+    state.size  = fs::file_size(path, ec);
+    state.mtime = fs::last_write_time(path, ec);
+    if (ec) return std::nullopt;
+    return state;
+}
+
+void DirectoryWatcher::update(fs::path const& path, Clock::time_point now) {
+    auto state = stat(path);
+    if (!state) {
+        mKnown.erase(path);
+        mPending.erase(path);
+        return;
+    }
+    if (auto known = mKnown.find(path); known != mKnown.end() && known->second == *state) {
+        mPending.erase(path);
+        return;
+    }
+    // Any change restarts the quiet period
+    auto pending = mPending.find(path);
+    if (pending == mPending.end() || !(pending->second.state == *state)) mPending[path] = {*state, now};
+}
+
+void DirectoryWatcher::rescan(Clock::time_point now) {
+    std::set<fs::path> seen;
+    std::error_code    ec;
+    for (auto& entry : fs::directory_iterator(mDirectory, ec)) {
+        seen.insert(entry.path());
+        update(entry.path(), now);
+    }
+    std::erase_if(mKnown, [&](auto const& item) { return !seen.contains(item.first); });
+    std::erase_if(mPending, [&](auto const& item) { return !seen.contains(item.first); });
+}
+
+std::vector<fs::path> DirectoryWatcher::takeSettled(Clock::time_point now) {
+    std::vector<fs::path> res;
+    for (auto it = mPending.begin(); it != mPending.end();) {
+        auto& [path, pending] = *it;
+        if (now - pending.since < mOptions.settleTime) {
+            ++it;
+            continue;
+        }
+        // Notifications only say something happened, make sure it's over
+        auto state = stat(path);
+        if (state && *state == pending.state) {
+            mKnown[path] = *state;
+            res.push_back(path);
+            it = mPending.erase(it);
+        } else if (state) {
+            pending = {*state, now};
+            ++it;
+        } else {
+            it = mPending.erase(it);
+        }
+    }
+    return res;
+}
+
+void DirectoryWatcher::run() {
+    // Arm the notifications, then look again for whatever arrived since start()
+    if (mNative) {
+        try {
+            mNative->wait(std::chrono::milliseconds(0));
+        } catch (const std::exception&) {
+            mNative.reset();
+        }
+        rescan(Clock::now());
+    }
+    while (true) {
+        std::optional<std::vector<fs::path>> changed; // nullopt to list the whole directory
+        if (mNative) {
+            try {
+                changed = mNative->wait(mOptions.pollInterval);
+            } catch (const std::exception&) {
+                mNative.reset();
+            }
+        } else {
+            std::unique_lock lock(mMutex);
+            mStopped.wait_for(lock, mOptions.pollInterval, [this] { return mStopping; });
+        }
+        {
+            std::lock_guard lock(mMutex);
+            if (mStopping) return;
+        }
+
+        auto now = Clock::now();
+        if (changed) {
+            for (auto& name : *changed) update(mDirectory / name, now);
+        } else {
+            rescan(now);
+        }
+        for (auto& path : takeSettled(now)) mHandler(path);
+    }
+}
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Reports files directly inside a directory once they were added or changed and then left alone for a while, so a
+// file still being copied is never picked up. Uses change notifications where the platform has them (Windows) and
+// falls back to comparing sizes and mtimes every poll interval elsewhere. Only the changed files are looked at when
+// notifications are available. The handler runs on the watcher thread.
+class DirectoryWatcher {
+public:
+    struct Options {
+        std::chrono::milliseconds pollInterval = std::chrono::milliseconds(1000);
+        std::chrono::milliseconds settleTime   = std::chrono::milliseconds(2000); // quiet time before reporting
+        bool                      forcePolling = false;
+        std::function<bool(std::filesystem::path const&)> filter; // files to watch, all of them if empty
+    };
+    using Handler = std::function<void(std::filesystem::path const&)>;
+
+    // Files already in the directory are taken as known and only reported once they change. Those added before
+    // start(), or while stopped, are reported once it starts.
+    DirectoryWatcher(std::filesystem::path directory, Options options, Handler onSettled);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(DirectoryWatcher const&)            = delete;
+    DirectoryWatcher& operator=(DirectoryWatcher const&) = delete;
+
+    void start();
+    void stop();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct State {
+        std::uintmax_t                  size = 0;
+        std::filesystem::file_time_type mtime;
+
+        bool operator==(State const&) const = default;
+    };
+    struct Pending {
+        State             state;
+        Clock::time_point since;
+    };
+    struct Native;
+
+    void                               run();
+    void                               update(std::filesystem::path const& path, Clock::time_point now);
+    void                               rescan(Clock::time_point now);
+    std::vector<std::filesystem::path> takeSettled(Clock::time_point now);
+    std::optional<State>               stat(std::filesystem::path const& path) const;
+
+    std::filesystem::path mDirectory;
+    Options               mOptions;
+    Handler               mHandler;
+
+    std::map<std::filesystem::path, State>   mKnown; // as last reported, or as found on construction
+    std::map<std::filesystem::path, Pending> mPending;
+    std::unique_ptr<Native>                  mNative; // null when polling
+
+    std::thread             mThread;
+    std::mutex              mMutex;
+    std::condition_variable mStopped;
+    bool                    mStopping = false;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,82 @@
+#include "DropFolderInstaller.h"
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+DirectoryWatcher::Options WithArchiveFilter(DirectoryWatcher::Options options) {
+    if (!options.filter) options.filter = IsAddonArchive;
+    return options;
+}
+
+} // namespace
+
+DropFolderInstaller::DropFolderInstaller(
+    fs::path                  folder,
+    AddonWorld&               world,
+    std::recursive_mutex&     worldMutex,
+    DirectoryWatcher::Options options
+)
+: mWorld(world),
+  mWorldMutex(worldMutex),
+  mWatcher(std::move(folder), WithArchiveFilter(std::move(options)), [this](fs::path const& archive) {
+      enqueue(archive);
+  }) {}
+
+DropFolderInstaller::~DropFolderInstaller() { stop(); }
+
+void DropFolderInstaller::start() {
+    if (mWorker.joinable()) return;
+    mStopping = false;
+    mWorker   = std::thread([this] { work(); });
+    mWatcher.start();
+}
+
+void DropFolderInstaller::stop() {
+    mWatcher.stop();
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mQueued.notify_all();
+    if (mWorker.joinable()) mWorker.join();
+    mQueue.clear();
+    mPending.clear();
+}
+
+void DropFolderInstaller::enqueue(fs::path const& archive) {
+    {
+        std::lock_guard lock(mMutex);
+        if (!mPending.insert(archive).second) return;
+        mQueue.push_back(archive);
+    }
+    mQueued.notify_one();
+}
+
+void DropFolderInstaller::work() {
+    while (true) {
+        fs::path archive;
+        {
+            std::unique_lock lock(mMutex);
+            mQueued.wait(lock, [this] { return mStopping || !mQueue.empty(); });
+            if (mStopping) return;
+            archive = std::move(mQueue.front());
+            mQueue.pop_front();
+            mPending.erase(archive);
+        }
+
+        std::error_code ec;
+        if (!fs::exists(archive, ec)) continue;
+        // A failed archive stays in the folder and is only retried once it is replaced. The world is only locked
+        // once the archive is extracted and checked, so the server isn't held up by a large one.
+        auto prepared = mWorld.prepareInstall(archive);
+        if (!prepared) continue;
+        std::lock_guard lock(mWorldMutex);
+        if (mWorld.commitInstall(*prepared))
+            mWorld.logger().info("ll.addonsHelper.autoInstall.hotInstalled", archive.filename());
+    }
+}
+
+} // namespace legacy_addons_manager
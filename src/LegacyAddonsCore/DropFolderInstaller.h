@@ -0,0 +1,49 @@
+#pragma once
+
+#include "AddonWorld.h"
+#include "DirectoryWatcher.h"
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <thread>
+
+namespace legacy_addons_manager {
+
+// Installs the archives dropped into a folder while the world is in use. The watcher only debounces and queues them,
+// installs run one at a time on a worker thread. It only holds worldMutex while the checked packs are swapped in, so
+// whoever reads the world in the meantime has to hold it too.
+class DropFolderInstaller {
+public:
+    DropFolderInstaller(
+        std::filesystem::path    folder,
+        AddonWorld&              world,
+        std::recursive_mutex&    worldMutex,
+        DirectoryWatcher::Options options = {}
+    );
+    ~DropFolderInstaller();
+
+    // Archives already in the folder when it is constructed are left to AddonWorld::installDirectory, construct it
+    // before calling that so nothing dropped in between is missed
+    void start();
+    void stop();
+
+private:
+    void enqueue(std::filesystem::path const& archive);
+    void work();
+
+    AddonWorld&           mWorld;
+    std::recursive_mutex& mWorldMutex;
+    DirectoryWatcher      mWatcher;
+
+    std::mutex                      mMutex;
+    std::condition_variable         mQueued;
+    std::deque<std::filesystem::path> mQueue;
+    std::set<std::filesystem::path> mPending; // queued, so a file reported twice is installed once
+    bool                            mStopping = false;
+    std::thread                     mWorker;
+};
+
+} // namespace legacy_addons_manager
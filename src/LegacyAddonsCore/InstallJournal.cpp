@@ -0,0 +1,175 @@
+#include "InstallJournal.h"
+#include "StringUtils.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::array STEP_NAMES = {"begun", "staged", "swapped", "listed", "done"};
+
+fs::path Sibling(fs::path const& target, std::u8string const& suffix) {
+    return target.parent_path() / (u8"." + target.filename().u8string() + suffix);
+}
+
+std::map<std::uint64_t, InstallJournal::Transaction> ReadTransactions(fs::path const& file) {
+    std::map<std::uint64_t, InstallJournal::Transaction> transactions;
+    std::ifstream                                        fin(file, std::ios::binary);
+    std::string                                          line;
+    while (std::getline(fin, line)) {
+        // A torn last line is what a crash in the middle of a write looks like, that step never happened
+        auto record = nlohmann::json::parse(line, nullptr, false);
+        if (!record.is_object() || !record.contains("id") || !record.contains("step")) continue;
+        auto id   = record["id"].get<std::uint64_t>();
+        auto step = std::find(STEP_NAMES.begin(), STEP_NAMES.end(), record["step"].get<std::string>());
+        if (step == STEP_NAMES.end()) continue;
+        auto& tx = transactions[id];
+        tx.id    = id;
+        tx.step  = InstallJournal::Step(step - STEP_NAMES.begin());
+        if (record.contains("uuid")) {
+            tx.uuid    = record["uuid"];
+            tx.target  = FromUtf8(record["target"].get<std::string>());
+            tx.staging = FromUtf8(record["staging"].get<std::string>());
+            tx.backup  = FromUtf8(record["backup"].get<std::string>());
+        }
+        if (record.contains("source")) tx.source = FromUtf8(record["source"].get<std::string>());
+    }
+    return transactions;
+}
+
+} // namespace
+
+InstallJournal::InstallJournal(fs::path file) : mFile(std::move(file)) {
+    auto transactions = ReadTransactions(mFile);
+    if (!transactions.empty()) mNextId = transactions.rbegin()->first + 1;
+    for (auto& [id, tx] : transactions)
+        if (tx.step != Step::Done) ++mOpen;
+}
+
+void InstallJournal::append(std::string const& line) {
+    std::ofstream fout(mFile, std::ios::binary | std::ios::app);
+    fout << line << '\n' << std::flush;
+    if (!fout) throw std::runtime_error("Fail to write install journal");
+}
+
+void InstallJournal::mark(Transaction& tx, Step step) {
+    nlohmann::json record = {
+        {"id",   tx.id                  },
+        {"step", STEP_NAMES[size_t(step)]}
+    };
+    append(record.dump());
+    tx.step = step;
+    // Nothing left to recover, start over with an empty journal
+    if (step == Step::Done && --mOpen == 0) {
+        std::error_code ec;
+        fs::remove(mFile, ec);
+    }
+}
+
+InstallJournal::Transaction InstallJournal::begin(std::string uuid, fs::path const& target) {
+    Transaction tx;
+    tx.id      = mNextId++;
+    tx.uuid    = std::move(uuid);
+    tx.target  = target;
+    tx.staging = Sibling(target, u8".staging");
+    tx.backup  = Sibling(target, u8".backup");
+
+    nlohmann::json record = {
+        {"id",      tx.id             },
+        {"step",    STEP_NAMES[0]     },
+        {"uuid",    tx.uuid           },
+        {"target",  ToUtf8(tx.target) },
+        {"staging", ToUtf8(tx.staging)},
+        {"backup",  ToUtf8(tx.backup) }
+    };
+    append(record.dump());
+    ++mOpen;
+    return tx;
+}
+
+void InstallJournal::stage(Transaction& tx, fs::path const& source, bool move) {
+    fs::remove_all(tx.staging);
+    if (move) {
+        nlohmann::json record = {
+            {"id",     tx.id                       },
+            {"step",   STEP_NAMES[size_t(tx.step)]},
+            {"source", ToUtf8(source)              }
+        };
+        append(record.dump());
+        tx.source = source;
+        fs::create_directories(tx.staging.parent_path());
+        fs::rename(source, tx.staging);
+    } else {
+        fs::create_directories(tx.staging);
+        fs::copy(source, tx.staging, fs::copy_options::recursive);
+    }
+    mark(tx, Step::Staged);
+}
+
+void InstallJournal::swap(Transaction& tx) {
+    fs::remove_all(tx.backup);
+    if (fs::exists(tx.target)) fs::rename(tx.target, tx.backup);
+    fs::rename(tx.staging, tx.target);
+    mark(tx, Step::Swapped);
+}
+
+void InstallJournal::retire(Transaction const& tx) {
+    if (mRetire && fs::exists(tx.backup)) {
+        try {
+            mRetire(tx);
+        } catch (...) {}
+    }
+    fs::remove_all(tx.backup);
+}
+
+void InstallJournal::commit(Transaction& tx) {
+    mark(tx, Step::Listed);
+    retire(tx);
+    mark(tx, Step::Done);
+}
+
+void InstallJournal::rollback(Transaction& tx) {
+    std::error_code ec;
+    // The journal can lag behind the disk: a staged pack whose staging directory is gone was already renamed into
+    // place by swap(), even if the crash came before the swapped record
+    bool swapped = tx.step >= Step::Swapped || (tx.step == Step::Staged && !fs::exists(tx.staging));
+    if (!tx.source.empty() && !fs::exists(tx.source)) {
+        auto moved = swapped ? tx.target : tx.staging;
+        if (fs::exists(moved)) {
+            fs::create_directories(tx.source.parent_path(), ec);
+            fs::rename(moved, tx.source, ec);
+        }
+    }
+    if (swapped) fs::remove_all(tx.target, ec);
+    fs::remove_all(tx.staging, ec);
+    // Also covers a crash between the two renames of swap()
+    if (!fs::exists(tx.target) && fs::exists(tx.backup)) fs::rename(tx.backup, tx.target);
+    mark(tx, Step::Done);
+}
+
+std::vector<std::pair<InstallJournal::Transaction, InstallJournal::Outcome>>
+InstallJournal::recover(std::function<bool(Transaction const&)> const& relist) {
+    std::vector<std::pair<Transaction, Outcome>> res;
+    for (auto& [id, tx] : ReadTransactions(mFile)) {
+        if (tx.step == Step::Done) continue;
+        if (tx.step == Step::Listed || (tx.step == Step::Swapped && relist(tx))) {
+            retire(tx);
+            mark(tx, Step::Done);
+            res.emplace_back(tx, Outcome::RolledForward);
+        } else {
+            rollback(tx);
+            res.emplace_back(tx, Outcome::RolledBack);
+        }
+    }
+    return res;
+}
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Write-ahead journal of pack installs. A pack is copied into a staging directory next to its target, then swapped in
+// with renames and listed in the world pack list; every step is journaled first, so an install interrupted at any point
+// can be rolled back or forward on the next start without touching the other packs.
+// Every method throws std::runtime_error or std::filesystem::filesystem_error on failure.
+class InstallJournal {
+public:
+    enum class Step { Begun, Staged, Swapped, Listed, Done };
+
+    struct Transaction {
+        std::uint64_t         id = 0;
+        std::string           uuid;
+        std::filesystem::path target;
+        std::filesystem::path staging;
+        std::filesystem::path backup; // the previous version while it is being replaced
+        std::filesystem::path source; // where a staged directory was moved from, it is moved back on rollback
+        Step                  step = Step::Begun;
+    };
+
+    enum class Outcome { RolledBack, RolledForward };
+
+    explicit InstallJournal(std::filesystem::path file);
+
+    // Called with the previous version once it is replaced, to keep it somewhere instead of deleting it. Whatever is
+    // left at the backup path afterwards is deleted.
+    void onRetire(std::function<void(Transaction const&)> handler) { mRetire = std::move(handler); }
+
+    Transaction begin(std::string uuid, std::filesystem::path const& target);
+    // Copy the pack into the staging directory, or move it there if move is set. A moved directory is journaled
+    // before it leaves source, so a rollback can give it back instead of deleting the only copy.
+    void stage(Transaction& tx, std::filesystem::path const& source, bool move = false);
+    // Move the current version aside and the staged one into place
+    void swap(Transaction& tx);
+    // The pack is listed, the previous version is no longer needed
+    void commit(Transaction& tx);
+    void rollback(Transaction& tx);
+
+    // Resolve the transactions left by a previous run. Swapped packs are rolled forward if relist succeeds, everything
+    // else is rolled back.
+    std::vector<std::pair<Transaction, Outcome>> recover(std::function<bool(Transaction const&)> const& relist);
+
+private:
+    void append(std::string const& line);
+    void mark(Transaction& tx, Step step);
+    void retire(Transaction const& tx);
+
+    std::filesystem::path mFile;
+    std::uint64_t         mNextId = 1;
+    size_t                mOpen   = 0;
+
+    std::function<void(Transaction const&)> mRetire;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,31 @@
+#include "LaxJson.h"
+
+namespace legacy_addons_manager {
+
+std::string NormalizeLaxJson(std::string_view content) {
+    std::string res(content);
+    size_t      pendingComma = std::string::npos;
+    for (size_t i = 0; i < res.size(); ++i) {
+        char c = res[i];
+        if (c == '"') {
+            for (++i; i < res.size() && res[i] != '"'; ++i)
+                if (res[i] == '\\') ++i;
+            pendingComma = std::string::npos;
+        } else if (c == '/' && i + 1 < res.size() && res[i + 1] == '/') {
+            while (i < res.size() && res[i] != '\n') ++i;
+        } else if (c == '/' && i + 1 < res.size() && res[i + 1] == '*') {
+            auto end = res.find("*/", i + 2);
+            i        = end == std::string::npos ? res.size() : end + 1;
+        } else if (c == ',') {
+            pendingComma = i;
+        } else if (c == ']' || c == '}') {
+            if (pendingComma != std::string::npos) res[pendingComma] = ' ';
+            pendingComma = std::string::npos;
+        } else if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            pendingComma = std::string::npos;
+        }
+    }
+    return res;
+}
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace legacy_addons_manager {
+
+// Rewrite Mojang's lax JSON dialect into something nlohmann::json accepts once comments are ignored: trailing commas
+// are blanked out. Byte offsets and line numbers are preserved, so parse errors still point into the original file.
+std::string NormalizeLaxJson(std::string_view content);
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "StringUtils.h"
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Where the core reports to. Messages are i18n keys of assets/lang, translated by whoever hosts the core (the mod
+// through LeviLamina, the CLI from the lang files) and formatted with FormatPattern.
+class Logger {
+public:
+    enum class Level { Debug, Info, Warn, Error };
+
+    using Sink      = std::function<void(Level, std::string const&)>;
+    using Translate = std::function<std::string(std::string const&)>;
+
+    // Without translate, keys are formatted as they are
+    explicit Logger(Sink sink, Translate translate = {}) : mSink(std::move(sink)), mTranslate(std::move(translate)) {}
+
+    template <class... Args>
+    void debug(std::string const& key, Args const&... args) const {
+        log(Level::Debug, key, {ToArg(args)...});
+    }
+    template <class... Args>
+    void info(std::string const& key, Args const&... args) const {
+        log(Level::Info, key, {ToArg(args)...});
+    }
+    template <class... Args>
+    void warn(std::string const& key, Args const&... args) const {
+        log(Level::Warn, key, {ToArg(args)...});
+    }
+    template <class... Args>
+    void error(std::string const& key, Args const&... args) const {
+        log(Level::Error, key, {ToArg(args)...});
+    }
+
+    void log(Level level, std::string const& key, std::vector<std::string> const& args) const {
+        if (mSink) mSink(level, FormatPattern(mTranslate ? mTranslate(key) : key, args));
+    }
+
+private:
+    template <class T>
+    static std::string ToArg(T const& value) {
+        if constexpr (std::is_convertible_v<T const&, std::string_view>) return std::string(std::string_view(value));
+        else if constexpr (std::is_same_v<T, std::filesystem::path>) return ToUtf8(value);
+        else if constexpr (std::is_arithmetic_v<T>) return std::to_string(value);
+        else return value.to_string();
+    }
+
+    Sink      mSink;
+    Translate mTranslate;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,101 @@
+#include "PackSnapshots.h"
+#include "Sha256.h"
+#include "StringUtils.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+PackSnapshots::PackSnapshots(fs::path root, size_t keep) : mRoot(std::move(root)), mKeep(keep) {
+    std::ifstream fin(mRoot / "index.json");
+    if (!fin) return;
+    auto index = nlohmann::json::parse(fin, nullptr, false);
+    if (!index.is_object()) return;
+    for (auto& [uuid, versions] : index.items()) {
+        if (!versions.is_array()) continue;
+        auto& list = mVersions[uuid];
+        for (auto& version : versions)
+            if (version.is_string() && fs::exists(directoryOf(uuid) / version.get<std::string>()))
+                list.push_back(version);
+    }
+}
+
+fs::path PackSnapshots::directoryOf(std::string const& uuid) const {
+    return mRoot / (IsSafeFileName(uuid) ? uuid : Sha256::hash(uuid));
+}
+
+std::vector<std::string> PackSnapshots::versions(std::string const& uuid) const {
+    auto it = mVersions.find(uuid);
+    return it == mVersions.end() ? std::vector<std::string>{} : it->second;
+}
+
+void PackSnapshots::retain(std::string const& uuid, std::string const& version, fs::path const& directory) {
+    if (!IsSafeFileName(version)) throw std::runtime_error("Invalid snapshot version " + version);
+    auto target = directoryOf(uuid) / version;
+    fs::create_directories(target.parent_path());
+    removeSnapshot(uuid, version);
+    fs::rename(directory, target);
+
+    auto& list = mVersions[uuid];
+    std::erase(list, version);
+    list.insert(list.begin(), version);
+    while (list.size() > mKeep) {
+        removeSnapshot(uuid, list.back());
+        list.pop_back();
+    }
+    saveIndex();
+}
+
+fs::path PackSnapshots::path(std::string const& uuid, std::string const& version) const {
+    auto it = mVersions.find(uuid);
+    if (it == mVersions.end() || std::find(it->second.begin(), it->second.end(), version) == it->second.end())
+        throw std::runtime_error("No snapshot of version " + version);
+    return directoryOf(uuid) / version;
+}
+
+void PackSnapshots::removeSnapshot(std::string const& uuid, std::string const& version) const {
+    auto archive   = archivePath(uuid, version);
+    auto checksum  = archive;
+    checksum      += ".sha256";
+    fs::remove_all(directoryOf(uuid) / version);
+    fs::remove(archive);
+    fs::remove(checksum);
+}
+
+fs::path PackSnapshots::archivePath(std::string const& uuid, std::string const& version) const {
+    return directoryOf(uuid) / (version + ".zip");
+}
+
+void PackSnapshots::forget(std::string const& uuid, std::string const& version) {
+    auto it = mVersions.find(uuid);
+    if (it == mVersions.end()) return;
+    std::erase(it->second, version);
+    if (it->second.empty()) mVersions.erase(it);
+    saveIndex();
+}
+
+void PackSnapshots::drop(std::string const& uuid) {
+    if (mVersions.erase(uuid) == 0) return;
+    fs::remove_all(directoryOf(uuid));
+    saveIndex();
+}
+
+void PackSnapshots::saveIndex() const {
+    fs::create_directories(mRoot);
+    auto index = nlohmann::json::object();
+    for (auto& [uuid, versions] : mVersions) index[uuid] = versions;
+    auto tmpPath = mRoot / "index.json.tmp";
+    {
+        std::ofstream fout(tmpPath, std::ios::binary | std::ios::trunc);
+        fout << index.dump(4);
+        if (!fout) throw std::runtime_error("Fail to write snapshot index");
+    }
+    fs::rename(tmpPath, mRoot / "index.json");
+}
+
+} // namespace legacy_addons_manager
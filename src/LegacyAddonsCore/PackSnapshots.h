@@ -0,0 +1,40 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Previous versions of installed packs, kept for instant rollback. Snapshots are moved in and out of the store with
+// renames, so the store has to be on the same volume as the packs and never costs a copy.
+// Every method throws std::runtime_error or std::filesystem::filesystem_error on failure.
+class PackSnapshots {
+public:
+    PackSnapshots(std::filesystem::path root, size_t keep);
+
+    // Versions with a snapshot, most recently retained first
+    [[nodiscard]] std::vector<std::string> versions(std::string const& uuid) const;
+
+    // Move a replaced pack directory into the store, dropping the oldest snapshots beyond the limit
+    void retain(std::string const& uuid, std::string const& version, std::filesystem::path const& directory);
+    // Where the snapshot lives, to move it out of the store before calling forget()
+    [[nodiscard]] std::filesystem::path path(std::string const& uuid, std::string const& version) const;
+    // The client download archive of the snapshot, kept next to its directory so a rollback doesn't rebuild it
+    [[nodiscard]] std::filesystem::path archivePath(std::string const& uuid, std::string const& version) const;
+    void                                forget(std::string const& uuid, std::string const& version);
+    // Drop every snapshot of the pack
+    void drop(std::string const& uuid);
+
+private:
+    [[nodiscard]] std::filesystem::path directoryOf(std::string const& uuid) const;
+    void                                removeSnapshot(std::string const& uuid, std::string const& version) const;
+    void                                saveIndex() const;
+
+    std::filesystem::path                           mRoot;
+    size_t                                          mKeep;
+    std::map<std::string, std::vector<std::string>> mVersions; // uuid -> versions, most recent first
+};
+
+} // namespace legacy_addons_manager
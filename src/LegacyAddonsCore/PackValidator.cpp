@@ -0,0 +1,307 @@
+#include "PackValidator.h"
+#include "Addon.h"
+#include "LaxJson.h"
+#include "Sha256.h"
+#include "StringUtils.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+namespace legacy_addons_manager {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr size_t MAX_CACHED_HASHES = 1 << 16;
+
+// Only cares about syntax, so nothing is built
+struct SyntaxCheckSax : nlohmann::json_sax<nlohmann::json> {
+    size_t      errorPosition = 0;
+    std::string errorMessage;
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t) override { return true; }
+    bool number_unsigned(number_unsigned_t) override { return true; }
+    bool number_float(number_float_t, string_t const&) override { return true; }
+    bool string(string_t&) override { return true; }
+    bool binary(binary_t&) override { return true; }
+    bool start_object(size_t) override { return true; }
+    bool key(string_t&) override { return true; }
+    bool end_object() override { return true; }
+    bool start_array(size_t) override { return true; }
+    bool end_array() override { return true; }
+
+    bool parse_error(size_t position, std::string const&, nlohmann::json::exception const& ex) override {
+        errorPosition = position;
+        errorMessage  = ex.what();
+        // Drop the "[json.exception.parse_error.101] parse error at line x, column y: " prefix
+        if (auto pos = errorMessage.find(": "); pos != std::string::npos) errorMessage.erase(0, pos + 2);
+        return false;
+    }
+};
+
+std::pair<size_t, size_t> LineAndColumn(std::string_view content, size_t position) {
+    position         = std::min(position, content.size());
+    size_t line      = 1 + std::count(content.begin(), content.begin() + position, '\n');
+    auto   lineBegin = content.rfind('\n', position == 0 ? 0 : position - 1);
+    size_t column    = lineBegin == std::string_view::npos ? position : position - lineBegin - 1;
+    return {line, std::max<size_t>(column, 1)};
+}
+
+void SortIssues(std::vector<ValidationIssue>& issues) {
+    std::sort(issues.begin(), issues.end(), [](ValidationIssue const& l, ValidationIssue const& r) {
+        return std::tie(l.file, l.line, l.column) < std::tie(r.file, r.line, r.column);
+    });
+}
+
+struct ManifestInfo {
+    std::string              file;
+    std::string              uuid;
+    std::string              name;
+    std::vector<std::string> moduleUuids;
+    std::vector<std::string> dependencies;
+};
+
+std::optional<ManifestInfo> ReadManifest(fs::path const& packDir, std::vector<ValidationIssue>& issues) {
+    auto path = packDir / "manifest.json";
+    if (!fs::exists(path)) path = packDir / "pack_manifest.json";
+
+    ManifestInfo info;
+    info.file = ToGenericUtf8(path);
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) {
+        issues.push_back({ValidationIssue::Severity::Error, ToGenericUtf8(packDir), 0, 0, "manifest.json not found"});
+        return std::nullopt;
+    }
+    std::ostringstream oss;
+    oss << fin.rdbuf();
+    // Syntax errors are reported by the file pass, just bail out here
+    auto manifest = nlohmann::json::parse(NormalizeLaxJson(oss.str()), nullptr, false, true);
+    if (manifest.is_discarded()) return std::nullopt;
+
+    auto error = [&](std::string message) {
+        issues.push_back({ValidationIssue::Severity::Error, info.file, 0, 0, std::move(message)});
+    };
+    auto header = manifest.find("header");
+    if (header == manifest.end() || !header->is_object()) {
+        error("Missing \"header\" object");
+        return std::nullopt;
+    }
+    if (!header->contains("uuid") || !(*header)["uuid"].is_string()) {
+        error("Missing header uuid");
+        return std::nullopt;
+    }
+    info.uuid = (*header)["uuid"];
+    if (header->contains("name") && (*header)["name"].is_string()) info.name = (*header)["name"];
+    // Same rules as when the pack is loaded, so whatever passes here can be installed
+    try {
+        ParseVersion(header->at("version"));
+    } catch (const std::exception&) {
+        error("Invalid header version");
+    }
+
+    auto modules = manifest.find("modules");
+    if (modules == manifest.end() || !modules->is_array() || modules->empty()) {
+        error("Missing \"modules\" array");
+    } else {
+        for (auto& module : *modules) {
+            if (module.contains("uuid") && module["uuid"].is_string()) info.moduleUuids.push_back(module["uuid"]);
+            else error("Module without uuid");
+        }
+    }
+    if (auto dependencies = manifest.find("dependencies"); dependencies != manifest.end() && dependencies->is_array()) {
+        for (auto& dependency : *dependencies) {
+            // Script API dependencies use "module_name" and are provided by the game
+            if (dependency.contains("uuid") && dependency["uuid"].is_string())
+                info.dependencies.push_back(dependency["uuid"]);
+        }
+    }
+    return info;
+}
+
+} // namespace
+
+PackValidator::PackValidator(fs::path cacheFile) : mCacheFile(std::move(cacheFile)) {
+    std::ifstream fin(mCacheFile);
+    if (!fin) return;
+    auto cache = nlohmann::json::parse(fin, nullptr, false);
+    if (!cache.is_array()) return;
+    for (auto& hash : cache)
+        if (hash.is_string()) mValidated.insert(hash.get<std::string>());
+}
+
+std::vector<ValidationIssue>
+PackValidator::validate(std::vector<fs::path> const& packDirs, std::vector<InstalledPack> const& installed) {
+    auto issues         = checkFiles(packDirs);
+    auto manifestIssues = checkManifests(packDirs, installed);
+    issues.insert(issues.end(), manifestIssues.begin(), manifestIssues.end());
+    SortIssues(issues);
+    return issues;
+}
+
+std::vector<ValidationIssue> PackValidator::checkFiles(std::vector<fs::path> const& packDirs) {
+    std::vector<ValidationIssue> issues;
+
+    std::vector<fs::path> files;
+    for (auto& packDir : packDirs) {
+        std::error_code ec;
+        for (auto& entry : fs::recursive_directory_iterator(packDir, ec)) {
+            if (!entry.is_regular_file()) continue;
+            auto ext = ToGenericUtf8(entry.path().extension());
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext == ".json") files.push_back(entry.path());
+        }
+    }
+
+    // Syntax pass, the part that actually costs time
+    std::mutex          issuesMutex;
+    std::atomic<size_t> next = 0;
+    auto                worker = [&] {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            std::ifstream fin(files[i], std::ios::binary);
+            if (!fin) {
+                std::lock_guard lock(issuesMutex);
+                issues.push_back(
+                    {ValidationIssue::Severity::Error, ToGenericUtf8(files[i]), 0, 0, "Fail to read file"}
+                );
+                continue;
+            }
+            std::ostringstream oss;
+            oss << fin.rdbuf();
+            auto content = std::move(oss).str();
+            auto hash    = Sha256::hash(content);
+            {
+                std::lock_guard lock(mMutex);
+                if (mValidated.contains(hash)) continue;
+            }
+            SyntaxCheckSax sax;
+            auto           normalized = NormalizeLaxJson(content);
+            if (nlohmann::json::sax_parse(normalized, &sax, nlohmann::json::input_format_t::json, true, true)) {
+                std::lock_guard lock(mMutex);
+                if (mValidated.size() >= MAX_CACHED_HASHES) mValidated.clear();
+                mValidated.insert(std::move(hash));
+                mDirty = true;
+            } else {
+                auto [line, column] = LineAndColumn(content, sax.errorPosition);
+                std::lock_guard lock(issuesMutex);
+                issues.push_back(
+                    {ValidationIssue::Severity::Error,
+                     ToGenericUtf8(files[i]),
+                     line,
+                     column,
+                     std::move(sax.errorMessage)}
+                );
+            }
+        }
+    };
+    size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), files.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    SortIssues(issues);
+    return issues;
+}
+
+std::vector<ValidationIssue> PackValidator::checkManifests(
+    std::vector<fs::path> const&      packDirs,
+    std::vector<InstalledPack> const& installed
+) const {
+    std::vector<ValidationIssue> issues;
+    std::vector<ManifestInfo>    manifests;
+    for (auto& packDir : packDirs)
+        if (auto info = ReadManifest(packDir, issues)) manifests.push_back(std::move(*info));
+
+    std::map<std::string, std::string> headerOwners; // uuid -> name, installed packs and the new ones
+    for (auto& pack : installed) headerOwners[pack.uuid] = pack.name;
+    std::set<std::string> batchUuids;
+    for (auto& manifest : manifests) {
+        if (!batchUuids.insert(manifest.uuid).second) {
+            issues.push_back(
+                {ValidationIssue::Severity::Error,
+                 manifest.file,
+                 0,
+                 0,
+                 "Header uuid " + manifest.uuid + " is used by more than one pack"}
+            );
+        }
+        headerOwners[manifest.uuid] = manifest.name;
+    }
+    std::map<std::string, std::string> moduleOwners; // module uuid -> name, the installed packs that stay
+    for (auto& pack : installed) {
+        if (batchUuids.contains(pack.uuid)) continue;
+        for (auto& moduleUuid : pack.moduleUuids) moduleOwners[moduleUuid] = pack.name;
+    }
+    for (auto& manifest : manifests) {
+        if (auto owner = moduleOwners.find(manifest.uuid); owner != moduleOwners.end()) {
+            issues.push_back(
+                {ValidationIssue::Severity::Error,
+                 manifest.file,
+                 0,
+                 0,
+                 "Header uuid " + manifest.uuid + " conflicts with a module of pack <" + owner->second + ">"}
+            );
+        }
+    }
+    for (auto& manifest : manifests) {
+        for (auto& moduleUuid : manifest.moduleUuids) {
+            if (moduleUuid == manifest.uuid) {
+                issues.push_back(
+                    {ValidationIssue::Severity::Error, manifest.file, 0, 0, "Module uuid equals the header uuid"}
+                );
+            } else if (auto owner = headerOwners.find(moduleUuid); owner != headerOwners.end()) {
+                issues.push_back(
+                    {ValidationIssue::Severity::Error,
+                     manifest.file,
+                     0,
+                     0,
+                     "Module uuid " + moduleUuid + " conflicts with pack <" + owner->second + ">"}
+                );
+            } else if (auto [owner, inserted] = moduleOwners.try_emplace(moduleUuid, manifest.name); !inserted) {
+                issues.push_back(
+                    {ValidationIssue::Severity::Error,
+                     manifest.file,
+                     0,
+                     0,
+                     "Module uuid " + moduleUuid + " conflicts with a module of pack <" + owner->second + ">"}
+                );
+            }
+        }
+        for (auto& dependency : manifest.dependencies) {
+            if (headerOwners.contains(dependency)) continue;
+            issues.push_back(
+                {ValidationIssue::Severity::Warning,
+                 manifest.file,
+                 0,
+                 0,
+                 "Dependency " + dependency + " is not installed"}
+            );
+        }
+    }
+
+    SortIssues(issues);
+    return issues;
+}
+
+void PackValidator::saveCache() {
+    std::lock_guard lock(mMutex);
+    if (!mDirty || mCacheFile.empty()) return;
+    auto cache = nlohmann::json::array();
+    for (auto& hash : mValidated) cache.push_back(hash);
+    std::ofstream fout(mCacheFile, std::ios::binary | std::ios::trunc);
+    fout << cache.dump();
+    mDirty = false;
+}
+
+} // namespace legacy_addons_manager
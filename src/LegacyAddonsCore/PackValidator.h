@@ -0,0 +1,57 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+struct ValidationIssue {
+    enum class Severity { Warning, Error };
+    Severity    severity;
+    std::string file;
+    size_t      line   = 0; // 0 if the issue isn't tied to a position
+    size_t      column = 0;
+    std::string message;
+};
+
+// Install-time pre-flight check of pack contents, so broken packs are rejected before the world ever loads them.
+class PackValidator {
+public:
+    struct InstalledPack {
+        std::string uuid;
+        std::string name;
+        std::string directory;
+
+        std::vector<std::string> moduleUuids;
+    };
+
+    // An empty cacheFile keeps the results in memory only
+    explicit PackValidator(std::filesystem::path cacheFile);
+
+    // Parse every JSON file of the packs in parallel and check their manifests against each other and the installed
+    // packs. An installed pack with the uuid of one of packDirs is about to be replaced, so it is left out of the
+    // checks. Files whose content already passed before are skipped.
+    std::vector<ValidationIssue>
+    validate(std::vector<std::filesystem::path> const& packDirs, std::vector<InstalledPack> const& installed);
+
+    // The two halves of validate(). Only checkManifests() looks at the installed packs, and it is cheap, so the file
+    // pass can run before the caller takes whatever lock guards them.
+    std::vector<ValidationIssue> checkFiles(std::vector<std::filesystem::path> const& packDirs);
+    std::vector<ValidationIssue> checkManifests(
+        std::vector<std::filesystem::path> const& packDirs,
+        std::vector<InstalledPack> const&         installed
+    ) const;
+
+    void saveCache();
+
+private:
+    std::filesystem::path           mCacheFile;
+    std::mutex                      mMutex;
+    std::unordered_set<std::string> mValidated; // sha256 of file contents
+    bool                            mDirty = false;
+};
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,143 @@
+#include "SearchIndex.h"
+#include "StringUtils.h"
+
+#include <algorithm>
+
+namespace legacy_addons_manager {
+
+namespace {
+
+constexpr float FIELD_WEIGHTS[] = {3.0f, 1.0f, 1.0f};
+// Matches sharing less than about a third of the query's trigrams are noise
+constexpr float MIN_SCORE = 0.34f;
+
+// Strip formatting codes and fold ASCII case
+std::string Normalize(std::string_view text) {
+    auto res = RemoveEscapeCode(text);
+    for (auto& c : res)
+        if (c >= 'A' && c <= 'Z') c = char(c - 'A' + 'a');
+    return res;
+}
+
+// Padded so that short strings and the start of a string get trigrams too. Queries aren't padded at the end, they are
+// often just the beginning of a word.
+std::vector<std::uint32_t> Trigrams(std::string_view normalized, bool padEnd = true) {
+    std::string                padded = "  " + std::string(normalized) + (padEnd ? " " : "");
+    std::vector<std::uint32_t> res;
+    res.reserve(padded.size());
+    for (size_t i = 0; i + 3 <= padded.size(); ++i) {
+        res.push_back(
+            (std::uint32_t(std::uint8_t(padded[i])) << 16) | (std::uint32_t(std::uint8_t(padded[i + 1])) << 8)
+            | std::uint32_t(std::uint8_t(padded[i + 2]))
+        );
+    }
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+}
+
+} // namespace
+
+void SearchIndex::add(std::string const& uuid, std::string_view name, std::string_view description) {
+    remove(uuid);
+
+    std::uint32_t slot;
+    if (!mFreeSlots.empty()) {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    } else {
+        slot = std::uint32_t(mDocuments.size());
+        mDocuments.emplace_back();
+    }
+    auto& document = mDocuments[slot];
+    document.uuid  = uuid;
+    document.name  = Normalize(name);
+    document.postings.clear();
+    mSlots[uuid] = slot;
+
+    std::string_view fields[FieldCount];
+    std::string      normalizedDescription = Normalize(description);
+    std::string      normalizedUuid        = Normalize(uuid);
+    fields[Name]                           = document.name;
+    fields[Description]                    = normalizedDescription;
+    fields[Uuid]                           = normalizedUuid;
+    for (std::uint32_t field = 0; field < FieldCount; ++field) {
+        for (auto trigram : Trigrams(fields[field])) {
+            mPostings[trigram].push_back(slot << 2 | field);
+            document.postings.push_back(trigram);
+        }
+    }
+}
+
+void SearchIndex::remove(std::string const& uuid) {
+    auto it = mSlots.find(uuid);
+    if (it == mSlots.end()) return;
+    auto  slot     = it->second;
+    auto& document = mDocuments[slot];
+    for (auto trigram : document.postings) {
+        auto posting = mPostings.find(trigram);
+        if (posting == mPostings.end()) continue;
+        std::erase_if(posting->second, [&](std::uint32_t entry) { return entry >> 2 == slot; });
+        if (posting->second.empty()) mPostings.erase(posting);
+    }
+    document = {};
+    mFreeSlots.push_back(slot);
+    mSlots.erase(it);
+}
+
+void SearchIndex::clear() {
+    mDocuments.clear();
+    mFreeSlots.clear();
+    mSlots.clear();
+    mPostings.clear();
+}
+
+std::vector<SearchIndex::Result> SearchIndex::search(std::string_view query, size_t limit) const {
+    auto normalized = Normalize(query);
+    if (normalized.empty()) return {};
+    auto trigrams = Trigrams(normalized, false);
+
+    // A trigram found in several fields of a pack counts once towards MIN_SCORE, the weights only rank the matches
+    std::vector<float>         scores(mDocuments.size(), 0.0f);
+    std::vector<std::uint32_t> matched(mDocuments.size(), 0);
+    std::vector<std::uint32_t> lastMatch(mDocuments.size(), 0); // 1 + index of the last trigram matched
+    std::vector<std::uint32_t> touched;
+    for (std::uint32_t i = 0; i < trigrams.size(); ++i) {
+        auto posting = mPostings.find(trigrams[i]);
+        if (posting == mPostings.end()) continue;
+        for (auto entry : posting->second) {
+            auto slot = entry >> 2;
+            if (scores[slot] == 0.0f) touched.push_back(slot);
+            scores[slot] += FIELD_WEIGHTS[entry & 3];
+            if (lastMatch[slot] != i + 1) {
+                lastMatch[slot] = i + 1;
+                ++matched[slot];
+            }
+        }
+    }
+
+    std::vector<std::pair<std::uint32_t, float>> matches;
+    for (auto slot : touched) {
+        if (float(matched[slot]) / float(trigrams.size()) < MIN_SCORE) continue;
+        auto& document = mDocuments[slot];
+        float score    = scores[slot] / float(trigrams.size());
+        if (document.name == normalized) score += 4.0f;
+        else if (document.name.starts_with(normalized)) score += 2.0f;
+        else if (document.name.find(normalized) != std::string::npos) score += 1.0f;
+        if (document.uuid.starts_with(normalized)) score += 4.0f;
+        matches.emplace_back(slot, score);
+    }
+    auto byScore = [&](std::pair<std::uint32_t, float> const& l, std::pair<std::uint32_t, float> const& r) {
+        if (l.second != r.second) return l.second > r.second;
+        return mDocuments[l.first].name < mDocuments[r.first].name;
+    };
+    limit = std::min(limit, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + std::ptrdiff_t(limit), matches.end(), byScore);
+
+    std::vector<Result> res;
+    res.reserve(limit);
+    for (size_t i = 0; i < limit; ++i) res.push_back({mDocuments[matches[i].first].uuid, matches[i].second});
+    return res;
+}
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Trigram index over the names, descriptions and uuids of the installed packs, with formatting codes stripped and
+// ASCII case folded. Updated one pack at a time on install and uninstall.
+class SearchIndex {
+public:
+    struct Result {
+        std::string uuid;
+        float       score;
+    };
+
+    // Index the pack, replacing what was indexed for the same uuid
+    void add(std::string const& uuid, std::string_view name, std::string_view description);
+    void remove(std::string const& uuid);
+    void clear();
+
+    // The best matches first, at most limit of them
+    [[nodiscard]] std::vector<Result> search(std::string_view query, size_t limit) const;
+
+private:
+    enum Field : std::uint32_t { Name, Description, Uuid, FieldCount };
+
+    struct Document {
+        std::string                uuid;
+        std::string                name;     // normalized
+        std::vector<std::uint32_t> postings; // trigrams this document was added under, for removal
+    };
+
+    std::vector<Document>                                         mDocuments;
+    std::vector<std::uint32_t>                                    mFreeSlots;
+    std::unordered_map<std::string, std::uint32_t>                mSlots;    // uuid -> slot
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> mPostings; // trigram -> slot << 2 | field
+};
+
+} // namespace legacy_addons_manager
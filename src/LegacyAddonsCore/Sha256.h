@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace legacy_addons_manager {
+
+class Sha256 {
+public:
+    using Digest = std::array<std::uint8_t, 32>;
+
+    Sha256();
+
+    Sha256& update(const void* data, size_t size);
+    Sha256& update(std::string_view data) { return update(data.data(), data.size()); }
+
+    Digest finish();
+
+    static std::string toHex(Digest const& digest);
+    static std::string hash(std::string_view data) { return toHex(Sha256().update(data).finish()); }
+
+private:
+    void transform(const std::uint8_t* block);
+
+    std::array<std::uint32_t, 8> mState;
+    std::array<std::uint8_t, 64> mBuffer;
+    size_t                       mBufferSize = 0;
+    std::uint64_t                mTotalSize  = 0;
+};
+
+} // namespace legacy_addons_manager
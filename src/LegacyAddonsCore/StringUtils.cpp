@@ -0,0 +1,76 @@
+#include "StringUtils.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace legacy_addons_manager {
+
+std::string ToUtf8(std::filesystem::path const& path) {
+    auto str = path.u8string();
+    return {reinterpret_cast<const char*>(str.data()), str.size()};
+}
+
+std::filesystem::path FromUtf8(std::string_view str) {
+    return std::filesystem::path(std::u8string(str.begin(), str.end()));
+}
+
+std::string ToGenericUtf8(std::filesystem::path const& path) {
+    auto str = path.generic_u8string();
+    return {reinterpret_cast<const char*>(str.data()), str.size()};
+}
+
+bool IsSafeFileName(std::string_view name) {
+    return !name.empty() && name != "." && name != ".." && std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '.';
+    });
+}
+
+std::string RemoveEscapeCode(std::string_view str) {
+    constexpr std::string_view SECTION_SIGN = "\xC2\xA7";
+
+    std::string res;
+    res.reserve(str.size());
+    for (size_t i = 0; i < str.size();) {
+        if (str.substr(i, SECTION_SIGN.size()) != SECTION_SIGN) {
+            res += str[i++];
+            continue;
+        }
+        i += SECTION_SIGN.size();
+        // Skip the code, which may be a multi-byte character too
+        if (i < str.size()) {
+            ++i;
+            while (i < str.size() && (static_cast<unsigned char>(str[i]) & 0xC0) == 0x80) ++i;
+        }
+    }
+    return res;
+}
+
+std::string FormatPattern(std::string_view pattern, std::vector<std::string> const& args) {
+    std::string res;
+    res.reserve(pattern.size());
+    size_t next = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        if ((c == '{' || c == '}') && i + 1 < pattern.size() && pattern[i + 1] == c) {
+            res += c;
+            ++i;
+            continue;
+        }
+        auto close = c == '{' ? pattern.find('}', i) : std::string_view::npos;
+        if (close == std::string_view::npos) {
+            res += c;
+            continue;
+        }
+        auto   field = pattern.substr(i + 1, close - i - 1);
+        size_t index = next;
+        auto   id    = field.substr(0, field.find(':'));
+        if (id.empty()) ++next;
+        else if (std::from_chars(id.data(), id.data() + id.size(), index).ec != std::errc{}) index = args.size();
+        if (index < args.size()) res += args[index];
+        else res.append(pattern.substr(i, close - i + 1));
+        i = close;
+    }
+    return res;
+}
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Paths are kept as UTF-8 in strings and JSON, whatever the native encoding is
+std::string           ToUtf8(std::filesystem::path const& path);
+std::filesystem::path FromUtf8(std::string_view str);
+// With / as separator on every platform, as in archive entry names
+std::string ToGenericUtf8(std::filesystem::path const& path);
+
+// Only ASCII letters, digits, - and ., and neither . nor .., so it is a plain file name on every platform. Names
+// taken from third-party manifests go through this before they are used as one.
+bool IsSafeFileName(std::string_view name);
+
+// Strip Minecraft formatting codes (§ followed by one character)
+std::string RemoveEscapeCode(std::string_view str);
+
+// Replace each {} of pattern with the next argument, or {n} with the n-th one. Format specs such as {:>2} are
+// accepted and ignored, {{ and }} are literal braces.
+std::string FormatPattern(std::string_view pattern, std::vector<std::string> const& args);
+
+} // namespace legacy_addons_manager
@@ -0,0 +1,426 @@
+#include "ZipArchive.h"
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <zlib.h>
+
+namespace legacy_addons_manager {
+
+namespace {
+
+// 1980-01-01 00:00:00, the earliest representable DOS time, so archives don't depend on file mtimes
+constexpr std::uint16_t FIXED_DOS_TIME = 0;
+constexpr std::uint16_t FIXED_DOS_DATE = (0 << 9) | (1 << 5) | 1;
+
+constexpr std::uint16_t METHOD_STORE   = 0;
+constexpr std::uint16_t METHOD_DEFLATE = 8;
+constexpr std::uint16_t FLAG_UTF8      = 1 << 11;
+
+struct ByteWriter {
+    std::string bytes;
+
+    void u16(std::uint16_t v) {
+        bytes.push_back(char(v & 0xff));
+        bytes.push_back(char(v >> 8));
+    }
+    void u32(std::uint32_t v) {
+        u16(std::uint16_t(v & 0xffff));
+        u16(std::uint16_t(v >> 16));
+    }
+};
+
+std::string Deflate(std::string_view data) {
+    z_stream stream{};
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        throw std::runtime_error("Fail to initialize deflate stream");
+    std::string out(deflateBound(&stream, uLong(data.size())), '\0');
+    stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in  = uInt(data.size());
+    stream.next_out  = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = uInt(out.size());
+    int res          = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    if (res != Z_STREAM_END) throw std::runtime_error("Fail to deflate data");
+    return out;
+}
+
+} // namespace
+
+ZipWriter::ZipWriter(std::filesystem::path const& path) : mOut(path, std::ios::binary | std::ios::trunc) {
+    if (!mOut) throw std::runtime_error("Fail to open " + path.string() + " for writing");
+}
+
+void ZipWriter::write(const void* data, size_t size) {
+    mOut.write(static_cast<const char*>(data), std::streamsize(size));
+    if (!mOut) throw std::runtime_error("Fail to write zip data");
+    mOffset += size;
+}
+
+void ZipWriter::add(std::string const& name, std::string_view data) {
+    if (data.size() > std::numeric_limits<std::uint32_t>::max() || mOffset > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Archive too large, zip64 is not supported");
+
+    Entry entry;
+    entry.name   = name;
+    entry.size   = std::uint32_t(data.size());
+    entry.crc    = std::uint32_t(crc32(0, reinterpret_cast<const Bytef*>(data.data()), uInt(data.size())));
+    entry.offset = std::uint32_t(mOffset);
+
+    std::string compressed = Deflate(data);
+    if (compressed.size() < data.size()) {
+        entry.method = METHOD_DEFLATE;
+        data         = compressed;
+    } else {
+        entry.method = METHOD_STORE;
+    }
+    entry.compressedSize = std::uint32_t(data.size());
+
+    ByteWriter header;
+    header.u32(0x04034b50);
+    header.u16(20);
+    header.u16(FLAG_UTF8);
+    header.u16(entry.method);
+    header.u16(FIXED_DOS_TIME);
+    header.u16(FIXED_DOS_DATE);
+    header.u32(entry.crc);
+    header.u32(entry.compressedSize);
+    header.u32(entry.size);
+    header.u16(std::uint16_t(name.size()));
+    header.u16(0);
+    header.bytes += name;
+    write(header.bytes.data(), header.bytes.size());
+    write(data.data(), data.size());
+
+    mEntries.emplace_back(std::move(entry));
+}
+
+void ZipWriter::finish() {
+    if (mEntries.size() > std::numeric_limits<std::uint16_t>::max()
+        || mOffset > std::numeric_limits<std::uint32_t>::max())
+        throw std::runtime_error("Archive too large, zip64 is not supported");
+
+    auto       directoryOffset = mOffset;
+    ByteWriter directory;
+    for (auto& entry : mEntries) {
+        directory.u32(0x02014b50);
+        directory.u16(20);
+        directory.u16(20);
+        directory.u16(FLAG_UTF8);
+        directory.u16(entry.method);
+        directory.u16(FIXED_DOS_TIME);
+        directory.u16(FIXED_DOS_DATE);
+        directory.u32(entry.crc);
+        directory.u32(entry.compressedSize);
+        directory.u32(entry.size);
+        directory.u16(std::uint16_t(entry.name.size()));
+        directory.u16(0);
+        directory.u16(0);
+        directory.u16(0);
+        directory.u16(0);
+        directory.u32(0);
+        directory.u32(entry.offset);
+        directory.bytes += entry.name;
+    }
+    auto directorySize = directory.bytes.size();
+    directory.u32(0x06054b50);
+    directory.u16(0);
+    directory.u16(0);
+    directory.u16(std::uint16_t(mEntries.size()));
+    directory.u16(std::uint16_t(mEntries.size()));
+    directory.u32(std::uint32_t(directorySize));
+    directory.u32(std::uint32_t(directoryOffset));
+    directory.u16(0);
+    write(directory.bytes.data(), directory.bytes.size());
+    mOut.flush();
+    if (!mOut) throw std::runtime_error("Fail to flush zip data");
+    mOut.close();
+}
+
+namespace {
+
+constexpr size_t        CHUNK_SIZE     = 64 * 1024;
+constexpr std::uint16_t HOST_UNIX      = 3;
+constexpr std::uint32_t UNIX_TYPE_MASK = 0170000;
+constexpr std::uint32_t UNIX_SYMLINK   = 0120000;
+
+struct CentralEntry {
+    std::string   name;
+    std::uint16_t flags;
+    std::uint16_t method;
+    std::uint32_t crc;
+    std::uint32_t compressedSize;
+    std::uint32_t size;
+    std::uint32_t externalAttributes;
+    std::uint16_t madeBy;
+    std::uint32_t offset;
+};
+
+std::uint16_t ReadU16(const unsigned char* p) { return std::uint16_t(p[0] | (p[1] << 8)); }
+std::uint32_t ReadU32(const unsigned char* p) {
+    return std::uint32_t(ReadU16(p)) | (std::uint32_t(ReadU16(p + 2)) << 16);
+}
+
+void ReadExact(std::ifstream& in, void* data, size_t size) {
+    in.read(static_cast<char*>(data), std::streamsize(size));
+    if (size_t(in.gcount()) != size) throw std::runtime_error("Unexpected end of archive");
+}
+
+// Unicode code points of the CP437 bytes 0x80 to 0xFF
+constexpr char16_t CP437_HIGH_HALF[128] = {
+    0x00C7, 0x00FC, 0x00E9, 0x00E2, 0x00E4, 0x00E0, 0x00E5, 0x00E7,
+    0x00EA, 0x00EB, 0x00E8, 0x00EF, 0x00EE, 0x00EC, 0x00C4, 0x00C5,
+    0x00C9, 0x00E6, 0x00C6, 0x00F4, 0x00F6, 0x00F2, 0x00FB, 0x00F9,
+    0x00FF, 0x00D6, 0x00DC, 0x00A2, 0x00A3, 0x00A5, 0x20A7, 0x0192,
+    0x00E1, 0x00ED, 0x00F3, 0x00FA, 0x00F1, 0x00D1, 0x00AA, 0x00BA,
+    0x00BF, 0x2310, 0x00AC, 0x00BD, 0x00BC, 0x00A1, 0x00AB, 0x00BB,
+    0x2591, 0x2592, 0x2593, 0x2502, 0x2524, 0x2561, 0x2562, 0x2556,
+    0x2555, 0x2563, 0x2551, 0x2557, 0x255D, 0x255C, 0x255B, 0x2510,
+    0x2514, 0x2534, 0x252C, 0x251C, 0x2500, 0x253C, 0x255E, 0x255F,
+    0x255A, 0x2554, 0x2569, 0x2566, 0x2560, 0x2550, 0x256C, 0x2567,
+    0x2568, 0x2564, 0x2565, 0x2559, 0x2558, 0x2552, 0x2553, 0x256B,
+    0x256A, 0x2518, 0x250C, 0x2588, 0x2584, 0x258C, 0x2590, 0x2580,
+    0x03B1, 0x00DF, 0x0393, 0x03C0, 0x03A3, 0x03C3, 0x00B5, 0x03C4,
+    0x03A6, 0x0398, 0x03A9, 0x03B4, 0x221E, 0x03C6, 0x03B5, 0x2229,
+    0x2261, 0x00B1, 0x2265, 0x2264, 0x2320, 0x2321, 0x00F7, 0x2248,
+    0x00B0, 0x2219, 0x00B7, 0x221A, 0x207F, 0x00B2, 0x25A0, 0x00A0,
+};
+
+bool IsValidUtf8(std::string_view str) {
+    for (size_t i = 0; i < str.size();) {
+        auto lead = std::uint8_t(str[i]);
+        if (lead < 0x80) {
+            ++i;
+            continue;
+        }
+        size_t        length = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 0;
+        std::uint32_t cp     = lead & (0x7F >> length);
+        if (length == 0 || lead > 0xF4 || i + length > str.size()) return false;
+        for (size_t k = 1; k < length; ++k) {
+            auto next = std::uint8_t(str[i + k]);
+            if ((next & 0xC0) != 0x80) return false;
+            cp = (cp << 6) | (next & 0x3F);
+        }
+        // Overlong forms, surrogates and code points past U+10FFFF don't convert to UTF-16
+        constexpr std::uint32_t MIN_CODE_POINT[] = {0, 0, 0x80, 0x800, 0x10000};
+        if (cp < MIN_CODE_POINT[length] || (cp >= 0xD800 && cp <= 0xDFFF) || cp > 0x10FFFF) return false;
+        i += length;
+    }
+    return true;
+}
+
+// Names without the UTF-8 flag are in the OEM code page of whoever made the archive, CP437 for Windows Explorer and
+// most older tools. Some tools write UTF-8 without setting the flag, so a name that is valid UTF-8 is kept as it is.
+std::string DecodeEntryName(std::string const& name, std::uint16_t flags) {
+    if (IsValidUtf8(name)) return name;
+    if (flags & FLAG_UTF8) throw std::runtime_error("Entry name \"" + name + "\" is not valid UTF-8");
+    std::string res;
+    res.reserve(name.size() * 2);
+    for (char c : name) {
+        auto byte = std::uint8_t(c);
+        if (byte < 0x80) {
+            res += c;
+            continue;
+        }
+        char16_t cp = CP437_HIGH_HALF[byte - 0x80];
+        if (cp < 0x800) {
+            res += char(0xC0 | (cp >> 6));
+        } else {
+            res += char(0xE0 | (cp >> 12));
+            res += char(0x80 | ((cp >> 6) & 0x3F));
+        }
+        res += char(0x80 | (cp & 0x3F));
+    }
+    return res;
+}
+
+std::filesystem::path SafeEntryPath(std::string name, ZipExtractLimits const& limits) {
+    for (auto& c : name)
+        if (c == '\\') c = '/';
+    if (name.empty() || name.front() == '/' || name.find(':') != std::string::npos
+        || name.find('\0') != std::string::npos)
+        throw std::runtime_error("Illegal entry name \"" + name + "\"");
+    size_t depth = 0;
+    size_t begin = 0;
+    while (begin < name.size()) {
+        auto end = name.find('/', begin);
+        if (end == std::string::npos) end = name.size();
+        auto part = std::string_view(name).substr(begin, end - begin);
+        if (part == "..") throw std::runtime_error("Entry \"" + name + "\" escapes the destination");
+        if (!part.empty() && part != ".") ++depth;
+        begin = end + 1;
+    }
+    if (depth > limits.maxPathDepth) throw std::runtime_error("Entry \"" + name + "\" is nested too deep");
+    return std::filesystem::path(std::u8string(name.begin(), name.end())).lexically_normal();
+}
+
+std::vector<CentralEntry> ReadCentralDirectory(std::ifstream& in, ZipExtractLimits const& limits) {
+    in.seekg(0, std::ios::end);
+    auto fileSize = std::uint64_t(in.tellg());
+    if (fileSize < 22) throw std::runtime_error("Not a zip archive");
+
+    // The end of central directory record is followed by a comment of at most 65535 bytes
+    auto                       tailSize = size_t(std::min<std::uint64_t>(fileSize, 22 + 0xffff));
+    std::vector<unsigned char> tail(tailSize);
+    in.seekg(std::streamoff(fileSize - tailSize));
+    ReadExact(in, tail.data(), tailSize);
+    const unsigned char* eocd = nullptr;
+    for (size_t i = tailSize - 22;; --i) {
+        if (ReadU32(&tail[i]) == 0x06054b50) {
+            eocd = &tail[i];
+            break;
+        }
+        if (i == 0) break;
+    }
+    if (!eocd) throw std::runtime_error("Not a zip archive");
+
+    auto entryCount      = ReadU16(eocd + 10);
+    auto directorySize   = ReadU32(eocd + 12);
+    auto directoryOffset = ReadU32(eocd + 16);
+    if (entryCount == 0xffff || directoryOffset == 0xffffffff) throw std::runtime_error("zip64 is not supported");
+    if (entryCount > limits.maxEntryCount) throw std::runtime_error("Too many entries");
+    if (std::uint64_t(directoryOffset) + directorySize > fileSize)
+        throw std::runtime_error("Corrupt central directory");
+
+    std::vector<CentralEntry> entries;
+    entries.reserve(entryCount);
+    in.seekg(directoryOffset);
+    for (size_t i = 0; i < entryCount; ++i) {
+        unsigned char header[46];
+        ReadExact(in, header, sizeof(header));
+        if (ReadU32(header) != 0x02014b50) throw std::runtime_error("Corrupt central directory");
+        CentralEntry entry;
+        entry.madeBy             = ReadU16(header + 4);
+        entry.flags              = ReadU16(header + 8);
+        entry.method             = ReadU16(header + 10);
+        entry.crc                = ReadU32(header + 16);
+        entry.compressedSize     = ReadU32(header + 20);
+        entry.size               = ReadU32(header + 24);
+        entry.externalAttributes = ReadU32(header + 38);
+        entry.offset             = ReadU32(header + 42);
+        auto nameSize            = ReadU16(header + 28);
+        auto extraSize           = ReadU16(header + 30);
+        auto commentSize         = ReadU16(header + 32);
+        entry.name.resize(nameSize);
+        ReadExact(in, entry.name.data(), nameSize);
+        in.seekg(extraSize + commentSize, std::ios::cur);
+        if (entry.size == 0xffffffff || entry.compressedSize == 0xffffffff || entry.offset == 0xffffffff)
+            throw std::runtime_error("zip64 is not supported");
+        entries.emplace_back(std::move(entry));
+    }
+    return entries;
+}
+
+} // namespace
+
+void ExtractZip(
+    std::filesystem::path const& archive,
+    std::filesystem::path const& destination,
+    ZipExtractLimits const&      limits,
+    ZipExtractUsage*             usage
+) {
+    namespace fs = std::filesystem;
+    std::ifstream in(archive, std::ios::binary);
+    if (!in) throw std::runtime_error("Fail to open archive");
+
+    auto entries = ReadCentralDirectory(in, limits);
+
+    ZipExtractUsage localUsage;
+    if (!usage) usage = &localUsage;
+    if (usage->entryCount + entries.size() > limits.maxEntryCount) throw std::runtime_error("Too many entries");
+    usage->entryCount += entries.size();
+    for (auto& entry : entries) usage->compressedSize += entry.compressedSize;
+
+    auto&                        totalSize       = usage->totalSize;
+    auto const&                  compressedTotal = usage->compressedSize;
+    std::array<char, CHUNK_SIZE> inBuffer;
+    std::array<char, CHUNK_SIZE> outBuffer;
+    for (auto& entry : entries) {
+        auto relative = SafeEntryPath(DecodeEntryName(entry.name, entry.flags), limits);
+        auto target   = destination / relative;
+
+        // Unix symlinks are stored as regular entries with the link target as content
+        if ((entry.madeBy >> 8) == HOST_UNIX && ((entry.externalAttributes >> 16) & UNIX_TYPE_MASK) == UNIX_SYMLINK)
+            throw std::runtime_error("Entry \"" + entry.name + "\" is a symbolic link");
+        if (entry.flags & 1) throw std::runtime_error("Entry \"" + entry.name + "\" is encrypted");
+
+        if (entry.name.ends_with('/') || entry.name.ends_with('\\')) {
+            fs::create_directories(target);
+            continue;
+        }
+        if (entry.method != METHOD_STORE && entry.method != METHOD_DEFLATE)
+            throw std::runtime_error("Entry \"" + entry.name + "\" uses an unsupported compression method");
+        if (totalSize + entry.size > limits.maxTotalSize)
+            throw std::runtime_error("Archive exceeds the uncompressed size limit");
+
+        unsigned char localHeader[30];
+        in.seekg(entry.offset);
+        ReadExact(in, localHeader, sizeof(localHeader));
+        if (ReadU32(localHeader) != 0x04034b50) throw std::runtime_error("Corrupt local header");
+        in.seekg(ReadU16(localHeader + 26) + ReadU16(localHeader + 28), std::ios::cur);
+
+        fs::create_directories(target.parent_path());
+        std::ofstream out(target, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Fail to create \"" + entry.name + "\"");
+
+        auto inflater = std::unique_ptr<z_stream, void (*)(z_stream*)>(new z_stream{}, [](z_stream* stream) {
+            inflateEnd(stream);
+            delete stream;
+        });
+        if (entry.method == METHOD_DEFLATE && inflateInit2(inflater.get(), -MAX_WBITS) != Z_OK)
+            throw std::runtime_error("Fail to initialize inflate stream");
+
+        std::uint64_t remaining = entry.compressedSize;
+        std::uint64_t written   = 0;
+        std::uint32_t crc       = std::uint32_t(crc32(0, nullptr, 0));
+        auto          emit      = [&](const char* data, size_t size) {
+            written   += size;
+            totalSize += size;
+            if (written > entry.size) throw std::runtime_error("Entry \"" + entry.name + "\" is larger than declared");
+            if (totalSize > limits.maxTotalSize)
+                throw std::runtime_error("Archive exceeds the uncompressed size limit");
+            if (written > limits.ratioSlack
+                && written / std::max<std::uint64_t>(entry.compressedSize, 1) > limits.maxRatio)
+                throw std::runtime_error("Entry \"" + entry.name + "\" exceeds the compression ratio limit");
+            if (totalSize > limits.ratioSlack
+                && totalSize / std::max<std::uint64_t>(compressedTotal, 1) > limits.maxRatio)
+                throw std::runtime_error("Archive exceeds the compression ratio limit");
+            crc = std::uint32_t(crc32(crc, reinterpret_cast<const Bytef*>(data), uInt(size)));
+            out.write(data, std::streamsize(size));
+            if (!out) throw std::runtime_error("Fail to write \"" + entry.name + "\"");
+        };
+
+        bool finished = entry.method == METHOD_STORE && remaining == 0;
+        while (remaining > 0 && !finished) {
+            auto count = size_t(std::min<std::uint64_t>(remaining, inBuffer.size()));
+            ReadExact(in, inBuffer.data(), count);
+            remaining -= count;
+            if (entry.method == METHOD_STORE) {
+                emit(inBuffer.data(), count);
+                finished = remaining == 0;
+                continue;
+            }
+            inflater->next_in  = reinterpret_cast<Bytef*>(inBuffer.data());
+            inflater->avail_in = uInt(count);
+            do {
+                inflater->next_out  = reinterpret_cast<Bytef*>(outBuffer.data());
+                inflater->avail_out = uInt(outBuffer.size());
+                int res             = inflate(inflater.get(), Z_NO_FLUSH);
+                if (res != Z_OK && res != Z_STREAM_END && res != Z_BUF_ERROR)
+                    throw std::runtime_error("Entry \"" + entry.name + "\" is corrupt");
+                emit(outBuffer.data(), outBuffer.size() - inflater->avail_out);
+                if (res == Z_STREAM_END) {
+                    finished = true;
+                    break;
+                }
+            } while (inflater->avail_out == 0);
+        }
+        if (!finished || written != entry.size || crc != entry.crc)
+            throw std::runtime_error("Entry \"" + entry.name + "\" is corrupt");
+    }
+}
+
+} // namespace legacy_addons_manager
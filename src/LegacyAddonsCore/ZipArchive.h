@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace legacy_addons_manager {
+
+// Minimal ZIP writer producing byte-identical archives for identical input: entries are written in the order they
+// are added, with a fixed timestamp and no extra fields. Every method throws std::runtime_error on failure.
+class ZipWriter {
+public:
+    explicit ZipWriter(std::filesystem::path const& path);
+
+    void add(std::string const& name, std::string_view data);
+    void finish();
+
+private:
+    struct Entry {
+        std::string   name;
+        std::uint16_t method;
+        std::uint32_t crc;
+        std::uint32_t compressedSize;
+        std::uint32_t size;
+        std::uint32_t offset;
+    };
+
+    void write(const void* data, size_t size);
+
+    std::ofstream      mOut;
+    std::vector<Entry> mEntries;
+    std::uint64_t      mOffset = 0;
+};
+
+struct ZipExtractLimits {
+    std::uint64_t maxTotalSize  = std::uint64_t(1) << 30; // uncompressed bytes of the whole archive
+    std::uint64_t maxEntryCount = 10000;                   // the end of central directory can count up to 65534
+    std::uint64_t maxRatio      = 200;                     // uncompressed / compressed, per entry and overall
+    std::uint64_t ratioSlack    = std::uint64_t(1) << 20;  // bytes an entry may inflate to before the ratio applies
+    size_t        maxPathDepth  = 32;
+};
+
+// What the archives extracted so far used of the limits. Archives extracted with the same usage share one budget,
+// so nesting archives in one another doesn't multiply it.
+struct ZipExtractUsage {
+    std::uint64_t totalSize      = 0;
+    std::uint64_t entryCount     = 0;
+    std::uint64_t compressedSize = 0;
+};
+
+// Stream the archive into destination, checking limits while inflating so a hostile archive is stopped at the first
+// offending byte with constant memory. Entries escaping destination, symlinks, encrypted entries and zip64 are
+// rejected. Throws std::runtime_error on failure, leaving whatever was extracted so far for the caller to clean up.
+void ExtractZip(
+    std::filesystem::path const& archive,
+    std::filesystem::path const& destination,
+    ZipExtractLimits const&      limits = {},
+    ZipExtractUsage*             usage  = nullptr
+);
+
+} // namespace legacy_addons_manager
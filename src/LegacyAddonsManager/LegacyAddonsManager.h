@@ -1,30 +1,29 @@
 #pragma once
 
+#include "LegacyAddonsCore/Addon.h"
+
 #include <ll/api/mod/NativeMod.h>
 
-namespace legacy_addons_manager {
+#include <optional>
+#include <string>
+#include <vector>
 
-struct Addon {
-    enum class Type { ResourcePack, BehaviorPack };
-    std::string       name;
-    std::string       description;
-    Type              type;
-    ll::data::Version version;
-    std::string       uuid;
-    std::string       directory;
-    bool              enable = false;
-};
+namespace legacy_addons_manager {
 
 class AddonsManager {
 public:
     static bool install(std::string path);
     static bool uninstall(std::string nameOrUuid);
 
-    static bool enable(std::string nameOrUuid);
+    static bool enable(std::string nameOrUuid, bool withDependencies = false);
     static bool disable(std::string nameOrUuid);
 
-    static std::vector<Addon*> getAllAddons();
-    static Addon*              findAddon(const std::string& nameOrUuid, bool fuzzy = false);
+    // Swap in a retained previous version, the most recent one if version is empty
+    static bool rollback(std::string nameOrUuid, std::string version = "");
+
+    // Copies, the drop folder installer may change the world as soon as they are returned
+    static std::vector<Addon>   getAllAddons();
+    static std::optional<Addon> findAddon(const std::string& nameOrUuid, bool fuzzy = false);
 };
 
 class LegacyAddonsManager {
@@ -2,16 +2,51 @@ add_rules("mode.debug", "mode.release")
 
 add_repositories("liteldev-repo https://github.com/LiteLDev/xmake-repo.git")
 
-add_requires("levilamina 0.13.5")
+if is_plat("windows") then
+    add_requires("levilamina 0.13.5")
+end
+add_requires("nlohmann_json 3.11.3")
+add_requires("zlib 1.3.1")
 
-if not has_config("vs_runtime") then
+if is_plat("windows") and not has_config("vs_runtime") then
     set_runtimes("MD")
 end
 
+-- Install, scan and list file logic, free of LeviLamina so it also builds on Linux
+target("LegacyAddonsCore")
+    if is_plat("windows") then
+        add_cxflags("/EHa", "/utf-8")
+        add_defines("NOMINMAX", "UNICODE", "_HAS_CXX23=1")
+    end
+    add_files("src/LegacyAddonsCore/**.cpp")
+    add_includedirs("src", {public = true})
+    add_packages("nlohmann_json", "zlib", {public = true})
+    set_kind("static")
+    set_languages("c++20")
+
+-- Provisions worlds offline, see README
+target("LegacyAddonsCli")
+    if is_plat("windows") then
+        add_cxflags("/EHa", "/utf-8")
+        add_defines("NOMINMAX", "UNICODE", "_HAS_CXX23=1")
+    else
+        add_syslinks("pthread")
+    end
+    add_deps("LegacyAddonsCore")
+    add_files("src/LegacyAddonsCli/**.cpp")
+    set_kind("binary")
+    set_languages("c++20")
+
+    after_build(function (target)
+        os.cp("assets/lang", path.join(target:targetdir(), "lang"))
+    end)
+
+if is_plat("windows") then
 target("LegacyAddonsManager")
     add_cxflags("/EHa", "/utf-8")
     add_defines("NOMINMAX", "UNICODE", "_HAS_CXX23=1")
-    add_files("src/**.cpp")
+    add_deps("LegacyAddonsCore")
+    add_files("src/LegacyAddonsManager/**.cpp")
     add_includedirs("src")
     add_packages("levilamina")
     add_shflags("/DELAYLOAD:bedrock_server.dll")
@@ -30,3 +65,4 @@ target("LegacyAddonsManager")
         
         plugin_packer.pack_plugin(target,plugin_define)
     end)
+end